@@ -0,0 +1,30 @@
+#!/usr/bin/env python3
+# Prepends the sdboot payload header to a boot binary, so the FPGA bootrom
+# only reads the sectors the binary uses and checks it with a CRC-32.
+# Layout (little-endian) matches struct payload_header in sdboot/sd.c.
+
+import argparse
+import struct
+import zlib
+
+SECTOR_SIZE_B = 512
+PAYLOAD_MAGIC = 0x544f4f42
+MAX_PAYLOAD_SIZE_B = 30 << 20
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Add an sdboot payload header to a boot binary")
+    parser.add_argument("infile", type=str, help="Boot binary, e.g. br-base-bin-nodisk-flat")
+    parser.add_argument("--outfile", type=str, default="payload.img", help="Output file")
+    args = parser.parse_args()
+
+    with open(args.infile, "rb") as f:
+        payload = f.read()
+
+    if not payload or len(payload) > MAX_PAYLOAD_SIZE_B:
+        parser.error(f"payload is {len(payload)} B, sdboot loads 1 B to {MAX_PAYLOAD_SIZE_B} B")
+
+    header = struct.pack("<III", PAYLOAD_MAGIC, len(payload), zlib.crc32(payload))
+
+    with open(args.outfile, "wb") as f:
+        f.write(header.ljust(SECTOR_SIZE_B, b"\0"))
+        f.write(payload)
@@ -8,7 +8,8 @@
 #define DEBUG
 #include "kprintf.h"
 
-// Total payload in B
+// Total payload in B, loaded when the partition has no payload header.
+// Also the largest size a header may ask for.
 #define PAYLOAD_SIZE_B (30 << 20) // default: 30MiB
 // A sector is 512 bytes, so (1 << 11) * 512B = 1 MiB
 #define SECTOR_SIZE_B 512
@@ -18,6 +19,17 @@
 // The sector at which the BBL partition starts
 #define BBL_PARTITION_START_SECTOR 34
 
+// Optional header sector in front of the payload, written by
+// fpga/scripts/mkpayload.py. With it, only the sectors the payload uses are
+// read and the payload is checked against a CRC-32 (as in zlib) once loaded.
+#define PAYLOAD_MAGIC 0x544f4f42 // "BOOT"
+
+struct payload_header {
+	uint32_t magic;
+	uint32_t size;	// payload size in B, not counting the header sector
+	uint32_t crc32;
+};
+
 #ifndef TL_CLK
 #error Must define TL_CLK
 #endif
@@ -33,19 +45,30 @@
 // @see https://ucb-bar.gitbook.io/baremetal-ide/baremetal-ide/using-peripheral-devices/sifive-ips/serial-peripheral-interface-spi
 #define SPI_DIV 	(((F_CLK * 1000) / SPI_CLK) / 2 - 1)
 
+// Depth of the SPI TX and RX FIFOs (SPIParams default)
+#define SPI_FIFO_DEPTH	8
+// Bytes drained each time the RX watermark is reached during block reads
+#define SPI_BURST	(SPI_FIFO_DEPTH / 2)
+
 static volatile uint32_t * const spi = (void *)(SPI_CTRL_ADDR);
 
-static inline uint8_t spi_xfer(uint8_t d)
+// Receives a byte that has already been queued for transmission
+static inline uint8_t spi_recv(void)
 {
 	int32_t r;
 
-	REG32(spi, SPI_REG_TXFIFO) = d;
 	do {
 		r = REG32(spi, SPI_REG_RXFIFO);
 	} while (r < 0);
 	return r;
 }
 
+static inline uint8_t spi_xfer(uint8_t d)
+{
+	REG32(spi, SPI_REG_TXFIFO) = d;
+	return spi_recv();
+}
+
 static inline uint8_t sd_dummy(void)
 {
 	return spi_xfer(0xFF);
@@ -159,12 +182,16 @@ static int sd_cmd16(void)
 	return rc;
 }
 
-static uint16_t crc16_round(uint16_t crc, uint8_t data) {
-	crc = (uint8_t)(crc >> 8) | (crc << 8);
-	crc ^= data;
-	crc ^= (uint8_t)(crc >> 4) & 0xf;
-	crc ^= crc << 12;
-	crc ^= (crc & 0xff) << 5;
+// CRC-16-CCITT of the SD data block, a nibble at a time
+static inline uint16_t crc16_round(uint16_t crc, uint8_t data)
+{
+	static const uint16_t table[16] = {
+		0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+		0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+	};
+
+	crc = (crc << 4) ^ table[(crc >> 12) ^ (data >> 4)];
+	crc = (crc << 4) ^ table[(crc >> 12) ^ (data & 0xf)];
 	return crc;
 }
 
@@ -174,54 +201,137 @@ static uint16_t crc16_round(uint16_t crc, uint8_t data) {
 
 static const char spinner[] = { '-', '/', '|', '\\' };
 
+static uint32_t crc32(const volatile uint8_t *p, uint32_t n)
+{
+	static const uint32_t table[16] = {
+		0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+		0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+		0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+		0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+	};
+	uint32_t crc = ~0U;
+
+	while (n-- > 0) {
+		crc ^= *p++;
+		crc = (crc >> 4) ^ table[crc & 0xf];
+		crc = (crc >> 4) ^ table[crc & 0xf];
+	}
+	return ~crc;
+}
+
+// Reads the next data block of a CMD18 transfer into p.
+// The dummy bytes that clock the block in are queued ahead of the reads, so
+// the link does not idle between bytes. At most SPI_FIFO_DEPTH bytes are in
+// flight, so the RX FIFO cannot overflow, and RX is drained SPI_BURST bytes
+// at a time once the watermark says they are there. TX is refilled before
+// the burst is stored and checked, so the CRC overlaps the next bytes.
+static int sd_read_block(volatile uint8_t *p)
+{
+	uint16_t crc, crc_exp;
+	long tx, n, k;
+
+	while (sd_dummy() != 0xFE);
+
+	// Data and CRC bytes
+	tx = SECTOR_SIZE_B + 2;
+	for (k = 0; k < SPI_FIFO_DEPTH; k++, tx--)
+		REG32(spi, SPI_REG_TXFIFO) = 0xFF;
+
+	crc = 0;
+	for (n = SECTOR_SIZE_B; n > 0; n -= SPI_BURST) {
+		uint8_t x[SPI_BURST];
+
+		while (!(REG32(spi, SPI_REG_IP) & SPI_IP_RXWM));
+		for (k = 0; k < SPI_BURST; k++)
+			x[k] = REG32(spi, SPI_REG_RXFIFO);
+		for (k = 0; k < SPI_BURST && tx > 0; k++, tx--)
+			REG32(spi, SPI_REG_TXFIFO) = 0xFF;
+
+		for (k = 0; k < SPI_BURST; k++) {
+			*p++ = x[k];
+			crc = crc16_round(crc, x[k]);
+		}
+	}
+
+	// The CRC bytes are already in flight
+	crc_exp = ((uint16_t)spi_recv() << 8);
+	crc_exp |= spi_recv();
+	return (crc != crc_exp);
+}
+
+static void sd_stop(void)
+{
+	sd_cmd_end();
+	sd_cmd(0x4C, 0, 0x01);
+	sd_cmd_end();
+}
+
 static int copy(void)
 {
 	volatile uint8_t *p = (void *)(PAYLOAD_DEST);
-	long i = PAYLOAD_SIZE;
+	const volatile struct payload_header *hdr = (void *)(PAYLOAD_DEST);
+	uint32_t size = PAYLOAD_SIZE_B;
+	uint32_t crc_exp = 0;
+	int has_header;
+	long i;
 	int rc = 0;
 
 	dputs("CMD18");
 
-	kprintf("LOADING 0x%x B PAYLOAD\r\n", PAYLOAD_SIZE_B);
-	kprintf("LOADING  ");
-
 	REG32(spi, SPI_REG_SCKDIV) = SPI_DIV;
+	// RXWM is pending while the RX FIFO holds at least SPI_BURST bytes
+	REG32(spi, SPI_REG_RXCTRL) = SPI_RXWM(SPI_BURST - 1);
 	if (sd_cmd(0x52, BBL_PARTITION_START_SECTOR, 0xE1) != 0x00) {
 		sd_cmd_end();
 		return 1;
 	}
-	do {
-		uint16_t crc, crc_exp;
-		long n;
-
-		crc = 0;
-		n = SECTOR_SIZE_B;
-		while (sd_dummy() != 0xFE);
-		do {
-			uint8_t x = sd_dummy();
-			*p++ = x;
-			crc = crc16_round(crc, x);
-		} while (--n > 0);
-
-		crc_exp = ((uint16_t)sd_dummy() << 8);
-		crc_exp |= sd_dummy();
-
-		if (crc != crc_exp) {
+
+	// The first sector is either a header, which the payload then
+	// overwrites, or the start of a headerless payload
+	if (sd_read_block(p)) {
+		kputs("CRC mismatch");
+		sd_stop();
+		return 1;
+	}
+	has_header = (hdr->magic == PAYLOAD_MAGIC);
+	if (has_header) {
+		size = hdr->size;
+		crc_exp = hdr->crc32;
+		if (size == 0 || size > PAYLOAD_SIZE_B) {
+			kprintf("BAD PAYLOAD SIZE 0x%x\r\n", size);
+			sd_stop();
+			return 1;
+		}
+		i = (size + SECTOR_SIZE_B - 1) / SECTOR_SIZE_B;
+	} else {
+		p += SECTOR_SIZE_B;
+		i = PAYLOAD_SIZE - 1;
+	}
+
+	kprintf("LOADING 0x%x B PAYLOAD\r\n", size);
+	kprintf("LOADING  ");
+
+	for (; i > 0; i--) {
+		if (sd_read_block(p)) {
 			kputs("\b- CRC mismatch ");
 			rc = 1;
 			break;
 		}
+		p += SECTOR_SIZE_B;
 
 		if (SPIN_UPDATE(i)) {
 			kputc('\b');
 			kputc(spinner[SPIN_INDEX(i)]);
 		}
-	} while (--i > 0);
-	sd_cmd_end();
-
-	sd_cmd(0x4C, 0, 0x01);
-	sd_cmd_end();
+	}
+	sd_stop();
 	kputs("\b ");
+
+	if (!rc && has_header &&
+	    crc32((const volatile uint8_t *)(PAYLOAD_DEST), size) != crc_exp) {
+		kputs("PAYLOAD CRC mismatch");
+		rc = 1;
+	}
 	return rc;
 }
 
@@ -0,0 +1,111 @@
+// See LICENSE for license details
+
+#include "bridge_bench.h"
+#include "mock_blockdev_widget.h"
+#include "mock_simif.h"
+
+#include "bridges/blockdev.h"
+
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t NTAGS = 4;
+constexpr uint32_t DISK_SECTORS = 1 << 14;
+
+// Backing store of +blkdev0=, sized to DISK_SECTORS
+std::string make_disk() {
+  std::string path = bench_options().tmpdir + "/blockdev_bench.XXXXXX";
+  int fd = mkstemp(&path[0]);
+  if (fd < 0 || ftruncate(fd, (off_t)DISK_SECTORS * SECTOR_SIZE) != 0) {
+    fprintf(stderr, "Could not create %s\n", path.c_str());
+    abort();
+  }
+  close(fd);
+  return path;
+}
+
+/**
+ * Issues one request of len sectors per iteration, with NTAGS requests in
+ * flight, and ticks the driver until the widget has seen every response.
+ */
+void run(bench_state_t &state, bool write, uint32_t len, bool on_disk) {
+  mock_simif_t sim(bench_options().mmio_latency_ns);
+  auto addrs = mock_mmio_addrs<BLOCKDEVBRIDGEMODULE_struct>(0);
+  std::string disk = on_disk ? make_disk() : "";
+  std::vector<std::string> args;
+  if (on_disk) {
+    args.push_back("+blkdev0=" + disk);
+  } else {
+    args.push_back("+blkdev-in-mem0=" + std::to_string(DISK_SECTORS));
+  }
+
+  uint64_t requests = 0;
+  uint64_t mmio = 0;
+  uint64_t trips = 0;
+  {
+    blockdev_t blockdev(sim, addrs, 0, args, NTAGS, 16);
+    mock_blockdev_widget_t widget;
+    widget.bind(sim, addrs);
+    blockdev.init();
+
+    uint64_t issued = 0;
+    const uint64_t start_mmio = sim.mmio_reads + sim.mmio_writes;
+    const uint64_t start_trips = sim.round_trips;
+    while (state.keep_running()) {
+      uint32_t tag = issued % NTAGS;
+      uint32_t offset = (uint32_t)((issued * len) % (DISK_SECTORS - len));
+      widget.reqs.push_back(blkdev_request{write, offset, len, tag});
+      if (write) {
+        for (uint32_t i = 0; i < len * SECTOR_BEATS; i++)
+          widget.data.push_back(blkdev_data{issued + i, tag});
+      }
+      issued++;
+
+      // Keep NTAGS requests outstanding, as a pipelined target would
+      uint64_t done_target = issued < NTAGS ? 0 : issued - NTAGS + 1;
+      auto done = [&] {
+        return write ? widget.acks : widget.resp_beats / (len * SECTOR_BEATS);
+      };
+      while (done() < done_target)
+        blockdev.tick();
+    }
+    while (!widget.reqs.empty() || !widget.data.empty())
+      blockdev.tick();
+    requests = issued;
+    mmio = sim.mmio_reads + sim.mmio_writes - start_mmio;
+    trips = sim.round_trips - start_trips;
+  }
+  if (on_disk)
+    unlink(disk.c_str());
+
+  state.set_items_processed(requests);
+  state.set_bytes_processed(requests * len * SECTOR_SIZE);
+  state.counters["mmio/req"] = (double)mmio / requests;
+  state.counters["trips/req"] = (double)trips / requests;
+}
+
+void BM_blockdev_read_1(bench_state_t &state) { run(state, false, 1, false); }
+void BM_blockdev_read_16(bench_state_t &state) {
+  run(state, false, MAX_REQ_LEN, false);
+}
+void BM_blockdev_write_1(bench_state_t &state) { run(state, true, 1, false); }
+void BM_blockdev_write_16(bench_state_t &state) {
+  run(state, true, MAX_REQ_LEN, false);
+}
+void BM_blockdev_disk_read_16(bench_state_t &state) {
+  run(state, false, MAX_REQ_LEN, true);
+}
+void BM_blockdev_disk_write_16(bench_state_t &state) {
+  run(state, true, MAX_REQ_LEN, true);
+}
+
+} // namespace
+
+BRIDGE_BENCHMARK(BM_blockdev_read_1);
+BRIDGE_BENCHMARK(BM_blockdev_read_16);
+BRIDGE_BENCHMARK(BM_blockdev_write_1);
+BRIDGE_BENCHMARK(BM_blockdev_write_16);
+BRIDGE_BENCHMARK(BM_blockdev_disk_read_16);
+BRIDGE_BENCHMARK(BM_blockdev_disk_write_16);
@@ -0,0 +1,432 @@
+// See LICENSE for license details
+
+/**
+ * Replays a block device request trace against blockdev_t through the mock
+ * MMIO path, keeping every tag in flight, and reports the host service
+ * latency of each request and whether the data read back is what was
+ * written. Use it to compare backend changes to the driver on equal terms.
+ *
+ * Traces are either read from a file (--trace), one request per line:
+ *
+ *   R <sector offset> <sectors>
+ *   W <sector offset> <sectors>
+ *
+ * or generated (--requests with --pattern, --write-ratio and --len), and
+ * can be saved with --record for later replays.
+ */
+
+#include "mock_blockdev_widget.h"
+#include "mock_simif.h"
+
+#include "bridges/blockdev.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+struct options_t {
+  std::string trace, record, disk;
+  uint64_t requests = 100000;
+  bool sequential = false;
+  double write_ratio = 0.5;
+  uint32_t min_len = 1;
+  uint32_t max_len = MAX_REQ_LEN;
+  uint32_t sectors = 1 << 16;
+  uint32_t tags = 8;
+  uint32_t chunk_beats = 8;
+  uint64_t mmio_latency_ns = 0;
+  uint64_t seed = 0;
+};
+
+struct request_t {
+  bool write;
+  uint32_t offset;
+  uint32_t len;
+};
+
+void usage(const char *argv0) {
+  printf(
+      "usage: %s [options]\n"
+      "  --trace=<file>          replay a recorded trace\n"
+      "  --record=<file>         save the replayed trace\n"
+      "  --requests=<n>          length of a generated trace (100000)\n"
+      "  --pattern=random|sequential\n"
+      "  --write-ratio=<0..1>    fraction of writes (0.5)\n"
+      "  --len=<min>[-<max>]     sectors per request (1-%d)\n"
+      "  --sectors=<n>           in-memory disk size (65536)\n"
+      "  --disk=<file>           use a disk image instead (+blkdev0)\n"
+      "  --tags=<n>              requests in flight, i.e. trackers (8)\n"
+      "  --chunk-beats=<n>       write beats sent per request before moving\n"
+      "                          on to the next one in flight (8)\n"
+      "  --mmio-latency-ns=<ns>  latency of every MMIO access (0)\n"
+      "  --seed=<n>\n",
+      argv0,
+      MAX_REQ_LEN);
+}
+
+std::vector<request_t> load_trace(const std::string &path) {
+  FILE *file = fopen(path.c_str(), "r");
+  if (!file) {
+    fprintf(stderr, "Could not open %s\n", path.c_str());
+    abort();
+  }
+  std::vector<request_t> trace;
+  char line[256];
+  while (fgets(line, sizeof(line), file)) {
+    char op;
+    uint32_t offset, len;
+    if (line[0] == '#' || line[0] == '\n')
+      continue;
+    if (sscanf(line, " %c %u %u", &op, &offset, &len) != 3 ||
+        (op != 'R' && op != 'W')) {
+      fprintf(stderr, "Bad trace line: %s", line);
+      abort();
+    }
+    trace.push_back(request_t{op == 'W', offset, len});
+  }
+  fclose(file);
+  return trace;
+}
+
+std::vector<request_t> generate_trace(const options_t &opts) {
+  std::mt19937_64 rng(opts.seed);
+  std::bernoulli_distribution write(opts.write_ratio);
+  std::uniform_int_distribution<uint32_t> len(opts.min_len, opts.max_len);
+  std::vector<request_t> trace;
+  uint32_t next = 0;
+  for (uint64_t i = 0; i < opts.requests; i++) {
+    request_t req{write(rng), 0, len(rng)};
+    if (opts.sequential) {
+      if (next + req.len > opts.sectors)
+        next = 0;
+      req.offset = next;
+      next += req.len;
+    } else {
+      req.offset = std::uniform_int_distribution<uint32_t>(
+          0, opts.sectors - req.len)(rng);
+    }
+    trace.push_back(req);
+  }
+  return trace;
+}
+
+// Contents of beat i of a write, unique per request
+uint64_t pattern(uint64_t seq, uint64_t i) {
+  uint64_t x = (seq << 20) ^ i ^ 0x9E3779B97F4A7C15ULL;
+  x ^= x >> 31;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  return x ^ (x >> 29);
+}
+
+struct in_flight_t {
+  uint64_t seq;
+  request_t req;
+  clock_type::time_point issued;
+  // Write data not yet handed to the widget, or read data received
+  std::vector<uint64_t> beats;
+  size_t next_beat = 0;
+  bool busy = false;
+};
+
+double percentile(std::vector<double> &samples, double p) {
+  if (samples.empty())
+    return 0;
+  size_t i = std::min(samples.size() - 1, (size_t)(p * samples.size()));
+  std::nth_element(samples.begin(), samples.begin() + i, samples.end());
+  return samples[i];
+}
+
+void report(const char *name, std::vector<double> &latencies_us) {
+  printf("%-6s %9zu  p50 %8.2f  p90 %8.2f  p99 %8.2f  p99.9 %8.2f  "
+         "max %8.2f us\n",
+         name,
+         latencies_us.size(),
+         percentile(latencies_us, 0.5),
+         percentile(latencies_us, 0.9),
+         percentile(latencies_us, 0.99),
+         percentile(latencies_us, 0.999),
+         percentile(latencies_us, 1.0));
+}
+
+class replay_t {
+public:
+  explicit replay_t(const options_t &opts)
+      : opts(opts), sim(opts.mmio_latency_ns),
+        addrs(mock_mmio_addrs<BLOCKDEVBRIDGEMODULE_struct>(0)),
+        blockdev(sim, addrs, 0, args(opts), opts.tags, 16), slots(opts.tags) {
+    widget.bind(sim, addrs);
+    widget.on_rresp = [this](const blkdev_data &beat) { on_rresp(beat); };
+    widget.on_wack = [this](uint32_t tag) { complete(tag); };
+    blockdev.init();
+    shadow.resize((size_t)blockdev.nsectors() * SECTOR_BEATS);
+  }
+
+  uint32_t nsectors() { return blockdev.nsectors(); }
+
+  /// Gives the shadow copy the contents of the disk, either by reading the
+  /// image or by writing every sector through the bridge.
+  void prefill() {
+    if (!opts.disk.empty()) {
+      FILE *file = fopen(opts.disk.c_str(), "r");
+      if (!file ||
+          fread(shadow.data(), SECTOR_SIZE, nsectors(), file) < nsectors()) {
+        fprintf(stderr, "Could not read %s\n", opts.disk.c_str());
+        abort();
+      }
+      fclose(file);
+      return;
+    }
+    std::vector<request_t> fill;
+    for (uint32_t off = 0; off < nsectors(); off += MAX_REQ_LEN) {
+      uint32_t len = std::min<uint32_t>(MAX_REQ_LEN, nsectors() - off);
+      fill.push_back(request_t{true, off, len});
+    }
+    run(fill, false);
+  }
+
+  /// Replays the trace, recording host latencies if timed.
+  void run(const std::vector<request_t> &trace, bool timed) {
+    this->timed = timed;
+    size_t next = 0;
+    while (next < trace.size() || in_flight > 0) {
+      while (next < trace.size() && in_flight < slots.size() &&
+             !conflicts(trace[next]))
+        issue(trace[next++]);
+      feed_write_data();
+      blockdev.tick();
+    }
+  }
+
+  std::vector<double> read_latencies_us, write_latencies_us;
+  uint64_t mismatches = 0;
+
+  uint64_t mmio_accesses() const {
+    return blockdev.mmio_reads + blockdev.mmio_writes;
+  }
+
+private:
+  static std::vector<std::string> args(const options_t &opts) {
+    if (!opts.disk.empty())
+      return {"+blkdev0=" + opts.disk};
+    return {"+blkdev-in-mem0=" + std::to_string(opts.sectors)};
+  }
+
+  const options_t &opts;
+  mock_simif_t sim;
+  BLOCKDEVBRIDGEMODULE_struct addrs;
+  blockdev_t blockdev;
+  mock_blockdev_widget_t widget;
+
+  // Indexed by tag
+  std::vector<in_flight_t> slots;
+  size_t in_flight = 0;
+  uint64_t seq = 0;
+  bool timed = false;
+  std::vector<uint64_t> shadow;
+
+  static bool overlap(const request_t &a, const request_t &b) {
+    return a.offset < b.offset + b.len && b.offset < a.offset + a.len;
+  }
+
+  // As in a real driver, a request waits for in-flight writes to the same
+  // sectors, or the data it sees would depend on the interleaving
+  bool conflicts(const request_t &req) const {
+    for (auto &slot : slots) {
+      if (slot.busy && (slot.req.write || req.write) &&
+          overlap(slot.req, req))
+        return true;
+    }
+    return false;
+  }
+
+  void issue(const request_t &req) {
+    if (req.len == 0 || req.len > MAX_REQ_LEN ||
+        req.offset + req.len > nsectors()) {
+      fprintf(stderr,
+              "Request %c %u %u is out of range\n",
+              req.write ? 'W' : 'R',
+              req.offset,
+              req.len);
+      abort();
+    }
+    uint32_t tag = 0;
+    while (slots[tag].busy)
+      tag++;
+    in_flight_t &slot = slots[tag];
+    slot.seq = seq++;
+    slot.req = req;
+    slot.busy = true;
+    slot.next_beat = 0;
+    slot.beats.clear();
+    if (req.write) {
+      for (size_t i = 0; i < req.len * SECTOR_BEATS; i++)
+        slot.beats.push_back(pattern(slot.seq, i));
+    }
+    in_flight++;
+    slot.issued = clock_type::now();
+    widget.reqs.push_back(blkdev_request{req.write, req.offset, req.len, tag});
+  }
+
+  // Interleaves the data beats of all writes in flight, chunk_beats at a time
+  void feed_write_data() {
+    for (uint32_t tag = 0; tag < slots.size(); tag++) {
+      in_flight_t &slot = slots[tag];
+      if (!slot.busy || !slot.req.write)
+        continue;
+      size_t end =
+          std::min(slot.beats.size(), slot.next_beat + opts.chunk_beats);
+      for (; slot.next_beat < end; slot.next_beat++)
+        widget.data.push_back(blkdev_data{slot.beats[slot.next_beat], tag});
+    }
+  }
+
+  void on_rresp(const blkdev_data &beat) {
+    in_flight_t &slot = slots.at(beat.tag);
+    if (!slot.busy || slot.req.write) {
+      fprintf(stderr, "Read response for idle tag %u\n", beat.tag);
+      abort();
+    }
+    slot.beats.push_back(beat.data);
+    if (slot.beats.size() == slot.req.len * SECTOR_BEATS)
+      complete(beat.tag);
+  }
+
+  void complete(uint32_t tag) {
+    in_flight_t &slot = slots.at(tag);
+    if (!slot.busy) {
+      fprintf(stderr, "Completion for idle tag %u\n", tag);
+      abort();
+    }
+    double us = std::chrono::duration<double, std::micro>(clock_type::now() -
+                                                          slot.issued)
+                    .count();
+    uint64_t *disk = &shadow[(size_t)slot.req.offset * SECTOR_BEATS];
+    if (slot.req.write) {
+      std::copy(slot.beats.begin(), slot.beats.end(), disk);
+      if (timed)
+        write_latencies_us.push_back(us);
+    } else {
+      if (!std::equal(slot.beats.begin(), slot.beats.end(), disk)) {
+        if (mismatches++ < 10)
+          fprintf(stderr,
+                  "Data mismatch: R %u %u\n",
+                  slot.req.offset,
+                  slot.req.len);
+      }
+      if (timed)
+        read_latencies_us.push_back(us);
+    }
+    slot.busy = false;
+    in_flight--;
+  }
+};
+
+bool parse(options_t &opts, const std::string &arg) {
+  auto value = [&](const char *prefix) -> const char * {
+    size_t n = strlen(prefix);
+    return arg.compare(0, n, prefix) == 0 ? arg.c_str() + n : nullptr;
+  };
+  const char *v;
+  if ((v = value("--trace="))) {
+    opts.trace = v;
+  } else if ((v = value("--record="))) {
+    opts.record = v;
+  } else if ((v = value("--disk="))) {
+    opts.disk = v;
+  } else if ((v = value("--requests="))) {
+    opts.requests = strtoull(v, nullptr, 10);
+  } else if ((v = value("--pattern="))) {
+    opts.sequential = std::string(v) == "sequential";
+  } else if ((v = value("--write-ratio="))) {
+    opts.write_ratio = atof(v);
+  } else if ((v = value("--len="))) {
+    char *end;
+    opts.min_len = opts.max_len = strtoul(v, &end, 10);
+    if (*end == '-')
+      opts.max_len = strtoul(end + 1, nullptr, 10);
+  } else if ((v = value("--sectors="))) {
+    opts.sectors = strtoul(v, nullptr, 10);
+  } else if ((v = value("--tags="))) {
+    opts.tags = strtoul(v, nullptr, 10);
+  } else if ((v = value("--chunk-beats="))) {
+    opts.chunk_beats = strtoul(v, nullptr, 10);
+  } else if ((v = value("--mmio-latency-ns="))) {
+    opts.mmio_latency_ns = strtoull(v, nullptr, 10);
+  } else if ((v = value("--seed="))) {
+    opts.seed = strtoull(v, nullptr, 10);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  options_t opts;
+  for (int i = 1; i < argc; i++) {
+    if (!parse(opts, argv[i])) {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (opts.min_len == 0 || opts.max_len > MAX_REQ_LEN ||
+      opts.min_len > opts.max_len || opts.tags == 0 ||
+      opts.chunk_beats == 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  replay_t replay(opts);
+  opts.sectors = replay.nsectors();
+  auto trace =
+      opts.trace.empty() ? generate_trace(opts) : load_trace(opts.trace);
+
+  if (!opts.record.empty()) {
+    FILE *file = fopen(opts.record.c_str(), "w");
+    if (!file) {
+      fprintf(stderr, "Could not open %s\n", opts.record.c_str());
+      abort();
+    }
+    for (auto &req : trace)
+      fprintf(file, "%c %u %u\n", req.write ? 'W' : 'R', req.offset, req.len);
+    fclose(file);
+  }
+
+  replay.prefill();
+
+  uint64_t mmio_start = replay.mmio_accesses();
+  uint64_t sectors = 0;
+  for (auto &req : trace)
+    sectors += req.len;
+  auto start = clock_type::now();
+  replay.run(trace, true);
+  double seconds =
+      std::chrono::duration<double>(clock_type::now() - start).count();
+
+  printf("%zu requests, %" PRIu64 " sectors in %.3f s: %.0f req/s, "
+         "%.1f MB/s, %.1f MMIO/req\n",
+         trace.size(),
+         sectors,
+         seconds,
+         trace.size() / seconds,
+         sectors * SECTOR_SIZE / seconds / 1e6,
+         (double)(replay.mmio_accesses() - mmio_start) / trace.size());
+  report("read", replay.read_latencies_us);
+  report("write", replay.write_latencies_us);
+  if (replay.mismatches) {
+    printf("FAIL: %" PRIu64 " reads returned stale or corrupt data\n",
+           replay.mismatches);
+    return 1;
+  }
+  printf("Data integrity: OK\n");
+  return 0;
+}
@@ -0,0 +1,216 @@
+// See LICENSE for license details
+
+#include "bridge_bench.h"
+#include "mock_simif.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct bench_t {
+  std::string name;
+  bench_fn_t fn;
+};
+
+struct result_t {
+  std::string name;
+  uint64_t iterations;
+  double ns_per_iter;
+  double items_per_second;
+  double bytes_per_second;
+  std::map<std::string, double> counters;
+};
+
+std::vector<bench_t> &registry() {
+  static std::vector<bench_t> benches;
+  return benches;
+}
+
+bench_options_t options;
+
+// Formats a rate with an SI suffix, e.g. "12.3M"
+std::string si(double value) {
+  const char *suffixes[] = {"", "k", "M", "G", "T"};
+  size_t i = 0;
+  while (value >= 1000 && i + 1 < sizeof(suffixes) / sizeof(suffixes[0])) {
+    value /= 1000;
+    i++;
+  }
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.3g%s", value, suffixes[i]);
+  return buf;
+}
+
+void usage(const char *argv0) {
+  printf("usage: %s [options]\n"
+         "  --filter=<substr>        only run benchmarks whose name matches\n"
+         "  --list                   list benchmarks and exit\n"
+         "  --min-time=<seconds>     minimum time per benchmark (%.2g)\n"
+         "  --mmio-latency-ns=<ns>   latency of every mock MMIO access (%lu)\n"
+         "  --mmio-pipelined         pay the latency once per MMIO batch\n"
+         "  --tmpdir=<dir>           scratch directory (%s)\n"
+         "  --set=<key>=<value>      benchmark-specific parameter\n"
+         "  --json=<file>            also write the results as JSON\n"
+         "  --label=<label>          label of the JSON results, e.g. commit\n",
+         argv0,
+         options.min_seconds,
+         (unsigned long)options.mmio_latency_ns,
+         options.tmpdir.c_str());
+}
+
+// Results in a form that can be collected per commit and compared
+void write_json(const std::string &path,
+                const std::string &label,
+                const std::vector<result_t> &results) {
+  FILE *file = fopen(path.c_str(), "w");
+  if (!file) {
+    fprintf(stderr, "Could not open %s\n", path.c_str());
+    abort();
+  }
+  fprintf(file,
+          "{\n  \"label\": \"%s\",\n  \"mmio_latency_ns\": %lu,\n"
+          "  \"mmio_pipelined\": %s,\n  \"benchmarks\": [",
+          label.c_str(),
+          (unsigned long)options.mmio_latency_ns,
+          options.mmio_pipelined ? "true" : "false");
+  for (size_t i = 0; i < results.size(); i++) {
+    auto &result = results[i];
+    fprintf(file,
+            "%s\n    {\"name\": \"%s\", \"iterations\": %lu, "
+            "\"ns_per_iter\": %.1f, \"items_per_second\": %.1f, "
+            "\"bytes_per_second\": %.1f",
+            i ? "," : "",
+            result.name.c_str(),
+            (unsigned long)result.iterations,
+            result.ns_per_iter,
+            result.items_per_second,
+            result.bytes_per_second);
+    for (auto &counter : result.counters)
+      fprintf(file, ", \"%s\": %g", counter.first.c_str(), counter.second);
+    fprintf(file, "}");
+  }
+  fprintf(file, "\n  ]\n}\n");
+  fclose(file);
+}
+
+} // namespace
+
+const bench_options_t &bench_options() { return options; }
+
+std::string bench_param(const std::string &key, const std::string &fallback) {
+  auto it = options.params.find(key);
+  return it == options.params.end() ? fallback : it->second;
+}
+
+double bench_param(const std::string &key, double fallback) {
+  auto it = options.params.find(key);
+  return it == options.params.end() ? fallback : atof(it->second.c_str());
+}
+
+bool bench_state_t::keep_running() {
+  auto now = std::chrono::steady_clock::now();
+  if (!started) {
+    started = true;
+    start = now;
+    return true;
+  }
+  iters++;
+  elapsed = std::chrono::duration<double>(now - start).count();
+  return elapsed < min_seconds;
+}
+
+bench_registrar_t::bench_registrar_t(const char *name, bench_fn_t fn) {
+  registry().push_back(bench_t{name, fn});
+}
+
+int bench_main(int argc, char **argv) {
+  std::string filter, json, label;
+  bool list = false;
+  for (int i = 1; i < argc; i++) {
+    std::string arg(argv[i]);
+    if (arg.find("--filter=") == 0) {
+      filter = arg.substr(9);
+    } else if (arg == "--list") {
+      list = true;
+    } else if (arg.find("--min-time=") == 0) {
+      options.min_seconds = atof(arg.c_str() + 11);
+    } else if (arg.find("--mmio-latency-ns=") == 0) {
+      options.mmio_latency_ns = strtoull(arg.c_str() + 18, nullptr, 10);
+    } else if (arg == "--mmio-pipelined") {
+      options.mmio_pipelined = true;
+    } else if (arg.find("--tmpdir=") == 0) {
+      options.tmpdir = arg.substr(9);
+    } else if (arg.find("--set=") == 0 && arg.find('=', 6) != arg.npos) {
+      size_t eq = arg.find('=', 6);
+      options.params[arg.substr(6, eq - 6)] = arg.substr(eq + 1);
+    } else if (arg.find("--json=") == 0) {
+      json = arg.substr(7);
+    } else if (arg.find("--label=") == 0) {
+      label = arg.substr(8);
+    } else {
+      usage(argv[0]);
+      return arg == "--help" ? 0 : 1;
+    }
+  }
+
+  if (list) {
+    for (auto &bench : registry())
+      printf("%s\n", bench.name.c_str());
+    return 0;
+  }
+
+  if (options.mmio_pipelined) {
+    mmio_batch_t::set_executor(mock_simif_t::issue_pipelined);
+  }
+  printf("MMIO latency: %lu ns%s\n",
+         (unsigned long)options.mmio_latency_ns,
+         options.mmio_pipelined ? " per batch" : "");
+  printf("%-36s %12s %14s %12s %12s  %s\n",
+         "Benchmark",
+         "Iterations",
+         "ns/iter",
+         "items/s",
+         "bytes/s",
+         "Counters");
+  std::vector<result_t> results;
+  for (auto &bench : registry()) {
+    if (bench.name.find(filter) == std::string::npos)
+      continue;
+
+    bench_state_t state(options.min_seconds);
+    bench.fn(state);
+    if (state.iters == 0) {
+      fprintf(stderr, "%s: ran no iterations\n", bench.name.c_str());
+      abort();
+    }
+
+    double seconds = state.elapsed;
+    result_t result{bench.name,
+                    state.iters,
+                    seconds * 1e9 / state.iters,
+                    state.items / seconds,
+                    state.bytes / seconds,
+                    state.counters};
+    printf("%-36s %12lu %14.1f %12s %12s ",
+           result.name.c_str(),
+           (unsigned long)result.iterations,
+           result.ns_per_iter,
+           state.items ? si(result.items_per_second).c_str() : "-",
+           state.bytes ? si(result.bytes_per_second).c_str() : "-");
+    for (auto &counter : result.counters)
+      printf(" %s=%.3g", counter.first.c_str(), counter.second);
+    printf("\n");
+    fflush(stdout);
+    results.push_back(std::move(result));
+  }
+
+  if (!json.empty())
+    write_json(json, label, results);
+  return 0;
+}
+
+int main(int argc, char **argv) { return bench_main(argc, argv); }
@@ -0,0 +1,85 @@
+// See LICENSE for license details
+#ifndef __BRIDGE_BENCH_H
+#define __BRIDGE_BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * Minimal benchmark harness for bridge drivers, modelled after Google
+ * Benchmark so results read the same way:
+ *
+ *   static void BM_uart_output(bench_state_t &state) {
+ *     ...setup...
+ *     while (state.keep_running()) {
+ *       ...one iteration...
+ *     }
+ *     state.set_items_processed(chars);
+ *     state.counters["mmio/char"] = ...;
+ *   }
+ *   BRIDGE_BENCHMARK(BM_uart_output);
+ */
+struct bench_options_t {
+  /// Minimum wall time of every benchmark.
+  double min_seconds = 0.5;
+  /// Latency added to every mock MMIO access, emulating the host link.
+  uint64_t mmio_latency_ns = 0;
+  /// Pay the latency once per MMIO batch instead (see
+  /// mock_simif_t::issue_pipelined()).
+  bool mmio_pipelined = false;
+  /// Scratch directory for the files a driver writes to.
+  std::string tmpdir = "/tmp";
+  /// Benchmark-specific parameters, given as --set=<key>=<value>.
+  std::map<std::string, std::string> params;
+};
+
+/// Options parsed from the command line of the benchmark binary.
+const bench_options_t &bench_options();
+
+/// Value of a --set parameter, or fallback if it was not given.
+std::string bench_param(const std::string &key, const std::string &fallback);
+double bench_param(const std::string &key, double fallback);
+
+class bench_state_t {
+public:
+  explicit bench_state_t(double min_seconds) : min_seconds(min_seconds) {}
+
+  /// True while another iteration should run; times the loop.
+  bool keep_running();
+  uint64_t iterations() const { return iters; }
+  double elapsed_seconds() const { return elapsed; }
+
+  /// Work done over the whole run, reported per second.
+  void set_items_processed(uint64_t n) { items = n; }
+  void set_bytes_processed(uint64_t n) { bytes = n; }
+
+  /// Values reported as-is, e.g. MMIO accesses per request.
+  std::map<std::string, double> counters;
+
+private:
+  friend int bench_main(int argc, char **argv);
+
+  double min_seconds;
+  bool started = false;
+  uint64_t iters = 0;
+  double elapsed = 0;
+  uint64_t items = 0;
+  uint64_t bytes = 0;
+  std::chrono::steady_clock::time_point start;
+};
+
+using bench_fn_t = void (*)(bench_state_t &);
+
+/// Registers a benchmark at static-initialization time.
+struct bench_registrar_t {
+  bench_registrar_t(const char *name, bench_fn_t fn);
+};
+
+#define BRIDGE_BENCHMARK(fn) static bench_registrar_t fn##_registrar(#fn, fn)
+
+/// Runs the registered benchmarks matching the command line; see --help.
+int bench_main(int argc, char **argv);
+
+#endif // __BRIDGE_BENCH_H
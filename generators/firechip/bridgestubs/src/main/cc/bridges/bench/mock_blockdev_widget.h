@@ -0,0 +1,87 @@
+// See LICENSE for license details
+#ifndef __MOCK_BLOCKDEV_WIDGET_H
+#define __MOCK_BLOCKDEV_WIDGET_H
+
+#include "mock_simif.h"
+
+#include "bridges/blockdev.h"
+
+#include <deque>
+#include <functional>
+
+/**
+ * Model of the block device widget, bound to the MMIO registers of a
+ * blockdev_t. Requests and write data the target issued sit in its queues
+ * until the driver dequeues them, while read responses and write acks are
+ * always accepted and handed to the callbacks.
+ */
+class mock_blockdev_widget_t {
+public:
+  // Depths of the widget's response queues, which the target drains at once
+  static constexpr uint32_t RRESP_ENTRIES = 32;
+  static constexpr uint32_t WACK_ENTRIES = 4;
+
+  std::deque<blkdev_request> reqs;
+  std::deque<blkdev_data> data;
+
+  std::function<void(const blkdev_data &)> on_rresp;
+  std::function<void(uint32_t tag)> on_wack;
+
+  uint64_t resp_beats = 0;
+  uint64_t acks = 0;
+
+  void bind(mock_simif_t &sim, const BLOCKDEVBRIDGEMODULE_struct &addrs) {
+    sim.on_read(addrs.bdev_req_valid, [this] { return !reqs.empty(); });
+    sim.on_read(addrs.bdev_req_write, [this] { return reqs.front().write; });
+    sim.on_read(addrs.bdev_req_offset, [this] { return reqs.front().offset; });
+    sim.on_read(addrs.bdev_req_len, [this] { return reqs.front().len; });
+    sim.on_read(addrs.bdev_req_tag, [this] { return reqs.front().tag; });
+    sim.on_write(addrs.bdev_req_ready, [this](uint32_t) { reqs.pop_front(); });
+    sim.on_read(addrs.bdev_req_count, [this] { return (uint32_t)reqs.size(); });
+
+    sim.on_read(addrs.bdev_data_valid, [this] { return !data.empty(); });
+    sim.on_read(addrs.bdev_data_data_upper,
+                [this] { return (uint32_t)(data.front().data >> 32); });
+    sim.on_read(addrs.bdev_data_data_lower,
+                [this] { return (uint32_t)data.front().data; });
+    sim.on_read(addrs.bdev_data_tag, [this] { return data.front().tag; });
+    sim.on_write(addrs.bdev_data_ready, [this](uint32_t) { data.pop_front(); });
+    sim.on_read(addrs.bdev_data_count,
+                [this] { return (uint32_t)data.size(); });
+
+    sim.on_read(addrs.bdev_rresp_ready, [] { return 1u; });
+    sim.on_read(addrs.bdev_rresp_space, [] { return RRESP_ENTRIES; });
+    sim.on_write(addrs.bdev_rresp_data_upper, [this](uint32_t bits) {
+      rresp.data = (rresp.data & 0xFFFFFFFF) | ((uint64_t)bits << 32);
+    });
+    sim.on_write(addrs.bdev_rresp_data_lower, [this](uint32_t bits) {
+      rresp.data = (rresp.data & ~0xFFFFFFFFULL) | bits;
+    });
+    sim.on_write(addrs.bdev_rresp_tag,
+                 [this](uint32_t tag) { rresp.tag = tag; });
+    sim.on_write(addrs.bdev_rresp_valid, [this](uint32_t) {
+      resp_beats++;
+      if (on_rresp)
+        on_rresp(rresp);
+    });
+
+    sim.on_read(addrs.bdev_wack_ready, [] { return 1u; });
+    sim.on_read(addrs.bdev_wack_space, [] { return WACK_ENTRIES; });
+    sim.on_write(addrs.bdev_wack_tag, [this](uint32_t tag) { wack_tag = tag; });
+    sim.on_write(addrs.bdev_wack_valid, [this](uint32_t) {
+      acks++;
+      if (on_wack)
+        on_wack(wack_tag);
+    });
+
+    sim.on_read(addrs.bdev_reqs_pending,
+                [this] { return !reqs.empty() || !data.empty(); });
+  }
+
+private:
+  // Response fields latched until the valid handshake
+  blkdev_data rresp{};
+  uint32_t wack_tag = 0;
+};
+
+#endif // __MOCK_BLOCKDEV_WIDGET_H
@@ -0,0 +1,132 @@
+// See LICENSE for license details
+#ifndef __MOCK_SIMIF_H
+#define __MOCK_SIMIF_H
+
+#include "core/config.h"
+#include "core/simif.h"
+
+#include "bridges/mmio_batch.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+/**
+ * Software stand-in for simif_t, used to exercise bridge drivers on the host.
+ *
+ * Every MMIO address behaves as a plain register unless a handler is bound to
+ * it, in which case accesses are forwarded to a model of the bridge's widget.
+ * Each access can be delayed by a fixed latency to emulate the host link
+ * (PCIe, XDMA, ...) of a real platform. issue_pipelined() stands in for a
+ * platform that overlaps the accesses of an MMIO batch, paying the latency
+ * once per batch.
+ */
+class mock_simif_t final : public simif_t {
+public:
+  using read_handler_t = std::function<uint32_t()>;
+  using write_handler_t = std::function<void(uint32_t)>;
+
+  explicit mock_simif_t(uint64_t mmio_latency_ns = 0)
+      : simif_t(target_config()), latency(mmio_latency_ns) {}
+
+  void write(size_t addr, uint32_t data) override {
+    delay();
+    store(addr, data);
+  }
+
+  uint32_t read(size_t addr) override {
+    delay();
+    return load(addr);
+  }
+
+  /// mmio_batch_t executor modelling a link that overlaps the accesses of a
+  /// batch.
+  static void issue_pipelined(simif_t &simif, mmio_batch_t &batch) {
+    auto &sim = static_cast<mock_simif_t &>(simif);
+    sim.delay();
+    for (auto &op : batch.operations()) {
+      if (op.is_read) {
+        op.data = sim.load(op.addr);
+      } else {
+        sim.store(op.addr, op.data);
+      }
+    }
+  }
+
+  /// Routes reads of addr to the handler instead of the register file.
+  void on_read(size_t addr, read_handler_t handler) {
+    read_handlers[addr] = std::move(handler);
+  }
+  /// Routes writes of addr to the handler instead of the register file.
+  void on_write(size_t addr, write_handler_t handler) {
+    write_handlers[addr] = std::move(handler);
+  }
+
+  /// Last value written to a plain register.
+  uint32_t peek(size_t addr) const {
+    auto reg = registers.find(addr);
+    return reg == registers.end() ? 0 : reg->second;
+  }
+
+  uint64_t mmio_reads = 0;
+  uint64_t mmio_writes = 0;
+  /// Link round trips paid, one per access or per pipelined batch.
+  uint64_t round_trips = 0;
+
+private:
+  std::chrono::nanoseconds latency;
+  std::unordered_map<size_t, uint32_t> registers;
+  std::unordered_map<size_t, read_handler_t> read_handlers;
+  std::unordered_map<size_t, write_handler_t> write_handlers;
+
+  static const TargetConfig &target_config() {
+    static const TargetConfig config{};
+    return config;
+  }
+
+  void store(size_t addr, uint32_t data) {
+    ++mmio_writes;
+    auto it = write_handlers.find(addr);
+    if (it != write_handlers.end()) {
+      it->second(data);
+    } else {
+      registers[addr] = data;
+    }
+  }
+
+  uint32_t load(size_t addr) {
+    ++mmio_reads;
+    auto it = read_handlers.find(addr);
+    if (it != read_handlers.end())
+      return it->second();
+    auto reg = registers.find(addr);
+    return reg == registers.end() ? 0 : reg->second;
+  }
+
+  // Busy-waits: sleeping would be far coarser than a link round trip
+  void delay() {
+    ++round_trips;
+    if (latency.count() == 0)
+      return;
+    auto until = std::chrono::steady_clock::now() + latency;
+    while (std::chrono::steady_clock::now() < until)
+      ;
+  }
+};
+
+/// Assigns consecutive MMIO addresses to the fields of a generated
+/// <BRIDGE>_struct, which only holds uint64_t register addresses.
+template <typename addrs_t>
+addrs_t mock_mmio_addrs(uint64_t base) {
+  static_assert(sizeof(addrs_t) % sizeof(uint64_t) == 0,
+                "MMIO address structs only hold uint64_t fields");
+  addrs_t addrs;
+  uint64_t *fields = reinterpret_cast<uint64_t *>(&addrs);
+  for (size_t i = 0; i < sizeof(addrs_t) / sizeof(uint64_t); i++)
+    fields[i] = base + i;
+  return addrs;
+}
+
+#endif // __MOCK_SIMIF_H
@@ -0,0 +1,130 @@
+// See LICENSE for license details
+#ifndef __MOCK_STREAM_ENGINE_H
+#define __MOCK_STREAM_ENGINE_H
+
+#include "core/bridge_driver.h"
+#include "core/stream_engine.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+/**
+ * Software stand-in for the StreamEngine, backing every stream with an
+ * in-memory FIFO of the given capacity.
+ *
+ * The device side of a stream is modelled by a callback. A to-host stream's
+ * source is asked to top its FIFO up on every pull(); a from-host stream's
+ * sink is offered the FIFO contents on every push() and returns how many
+ * bytes it consumed. Sources and sinks choose how much they move per call,
+ * which sets the rate of the emulated FPGA side. As on hardware, streams only
+ * move whole beats of STREAM_WIDTH_BYTES.
+ */
+class mock_stream_engine_t final : public StreamEngine {
+public:
+  using source_t = std::function<size_t(char *dest, size_t max_bytes)>;
+  using sink_t = std::function<size_t(const char *src, size_t bytes)>;
+
+  mock_stream_engine_t(simif_t &simif,
+                       size_t num_to_cpu,
+                       size_t num_from_cpu,
+                       size_t capacity_bytes)
+      : StreamEngine(simif, &KIND), to_cpu(num_to_cpu, fifo_t(capacity_bytes)),
+        from_cpu(num_from_cpu, fifo_t(capacity_bytes)) {}
+
+  void init() override {}
+
+  void set_source(unsigned idx, source_t source) {
+    to_cpu.at(idx).device = std::move(source);
+  }
+  void set_sink(unsigned idx, sink_t sink) {
+    from_cpu.at(idx).device = [sink](char *buf, size_t bytes) {
+      return sink(buf, bytes);
+    };
+  }
+
+  size_t pull(unsigned idx,
+              void *dest,
+              size_t num_bytes,
+              size_t required_bytes) override {
+    fifo_t &fifo = to_cpu.at(idx);
+    if (fifo.device)
+      fifo.fill();
+    if (fifo.size() < required_bytes)
+      return 0;
+    size_t bytes = round_down(std::min(num_bytes, fifo.size()));
+    fifo.read(static_cast<char *>(dest), bytes);
+    return bytes;
+  }
+
+  size_t push(unsigned idx,
+              void *src,
+              size_t num_bytes,
+              size_t required_bytes) override {
+    fifo_t &fifo = from_cpu.at(idx);
+    if (fifo.device)
+      fifo.drain();
+    size_t space = fifo.capacity - fifo.size();
+    if (space < required_bytes)
+      return 0;
+    size_t bytes = round_down(std::min(num_bytes, space));
+    fifo.write(static_cast<const char *>(src), bytes);
+    if (fifo.device)
+      fifo.drain();
+    return bytes;
+  }
+
+  bool pull_flush(unsigned) override { return true; }
+  bool push_flush(unsigned) override { return true; }
+
+  /// Bytes waiting in a from-host stream, for models without a sink.
+  size_t from_cpu_bytes(unsigned idx) const { return from_cpu.at(idx).size(); }
+
+private:
+  static inline char KIND;
+
+  struct fifo_t {
+    explicit fifo_t(size_t capacity) : buf(capacity), capacity(capacity) {}
+
+    std::vector<char> buf;
+    size_t capacity;
+    // Bytes in [head, tail) are queued; compacted lazily
+    size_t head = 0;
+    size_t tail = 0;
+    std::function<size_t(char *, size_t)> device;
+
+    size_t size() const { return tail - head; }
+
+    void compact() {
+      if (head == 0)
+        return;
+      memmove(buf.data(), buf.data() + head, size());
+      tail -= head;
+      head = 0;
+    }
+    void read(char *dest, size_t bytes) {
+      memcpy(dest, buf.data() + head, bytes);
+      head += bytes;
+    }
+    void write(const char *src, size_t bytes) {
+      compact();
+      memcpy(buf.data() + tail, src, bytes);
+      tail += bytes;
+    }
+    void fill() {
+      compact();
+      tail += round_down(device(buf.data() + tail, capacity - tail));
+    }
+    void drain() { head += device(buf.data() + head, size()); }
+  };
+
+  std::vector<fifo_t> to_cpu;
+  std::vector<fifo_t> from_cpu;
+
+  static size_t round_down(size_t bytes) {
+    return bytes - bytes % streaming_bridge_driver_t::STREAM_WIDTH_BYTES;
+  }
+};
+
+#endif // __MOCK_STREAM_ENGINE_H
@@ -0,0 +1,63 @@
+// See LICENSE for license details
+
+#include "bridge_bench.h"
+#include "mock_simif.h"
+#include "mock_stream_engine.h"
+
+#include "bridges/simplenic.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Must be a multiple of the 7 tokens in a big token
+constexpr int LINK_LATENCY = 6405;
+constexpr int ROUND_BEATS = LINK_LATENCY / 7;
+
+/**
+ * Runs the NIC in loopback: between two ticks the FPGA side produces
+ * rounds_per_tick rounds of big tokens and takes back whatever the driver
+ * returns.
+ */
+void run(bench_state_t &state, int rounds_per_tick) {
+  constexpr size_t beat_bytes = streaming_bridge_driver_t::STREAM_WIDTH_BYTES;
+  const size_t round_bytes = ROUND_BEATS * beat_bytes;
+  mock_simif_t sim(bench_options().mmio_latency_ns);
+  mock_stream_engine_t stream(
+      sim, 1, 1, (rounds_per_tick + 1) * round_bytes);
+  auto addrs = mock_mmio_addrs<SIMPLENICBRIDGEMODULE_struct>(0);
+  std::vector<std::string> args = {
+      "+nic-loopback0", "+linklatency0=" + std::to_string(LINK_LATENCY)};
+  simplenic_t nic(
+      sim, stream, addrs, 0, args, 0, ROUND_BEATS, 0, ROUND_BEATS);
+
+  stream.set_sink(0, [](const char *, size_t bytes) { return bytes; });
+  nic.init();
+
+  size_t budget = 0;
+  stream.set_source(0, [&](char *dest, size_t max_bytes) {
+    size_t bytes = std::min(budget, max_bytes - max_bytes % beat_bytes);
+    memset(dest, 0, bytes);
+    budget -= bytes;
+    return bytes;
+  });
+
+  while (state.keep_running()) {
+    budget = rounds_per_tick * round_bytes;
+    nic.tick();
+  }
+
+  state.set_items_processed(nic.bytes_pulled / beat_bytes);
+  state.set_bytes_processed(nic.bytes_pulled + nic.bytes_pushed);
+  state.counters["rounds/tick"] =
+      (double)nic.bytes_pulled / round_bytes / state.iterations();
+}
+
+void BM_simplenic_loopback_1(bench_state_t &state) { run(state, 1); }
+void BM_simplenic_loopback_4(bench_state_t &state) { run(state, 4); }
+
+} // namespace
+
+BRIDGE_BENCHMARK(BM_simplenic_loopback_1);
+BRIDGE_BENCHMARK(BM_simplenic_loopback_4);
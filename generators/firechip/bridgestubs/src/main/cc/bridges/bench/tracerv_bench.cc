@@ -0,0 +1,78 @@
+// See LICENSE for license details
+
+#include "bridge_bench.h"
+#include "mock_simif.h"
+#include "mock_stream_engine.h"
+
+#include "bridges/tracerv.h"
+
+#include <unistd.h>
+
+namespace {
+
+constexpr int STREAM_DEPTH = 256;
+constexpr unsigned MAX_CORE_IPC = 7;
+
+/**
+ * Keeps the trace stream full: each beat holds a cycle count followed by
+ * MAX_CORE_IPC valid retired instruction addresses.
+ */
+size_t trace_source(char *dest, size_t max_bytes) {
+  constexpr size_t beat_bytes = streaming_bridge_driver_t::STREAM_WIDTH_BYTES;
+  static uint64_t cycle = 0;
+  size_t bytes = max_bytes - max_bytes % beat_bytes;
+  uint64_t *words = reinterpret_cast<uint64_t *>(dest);
+  for (size_t i = 0; i < bytes / sizeof(uint64_t); i += 8) {
+    words[i] = cycle++;
+    for (unsigned q = 0; q < MAX_CORE_IPC; q++)
+      words[i + 1 + q] = (1ULL << 63) | (0x80000000 + 4 * (cycle * 8 + q));
+  }
+  return bytes;
+}
+
+/// Drains a full stream per tick, writing the trace out with the given
+/// +trace-output-format.
+void run(bench_state_t &state, int format) {
+  constexpr size_t beat_bytes = streaming_bridge_driver_t::STREAM_WIDTH_BYTES;
+  mock_simif_t sim(bench_options().mmio_latency_ns);
+  mock_stream_engine_t stream(sim, 1, 0, STREAM_DEPTH * beat_bytes);
+  auto addrs = mock_mmio_addrs<TRACERVBRIDGEMODULE_struct>(0);
+
+  std::string tracefile = bench_options().tmpdir + "/tracerv_bench";
+  std::vector<std::string> args = {
+      "+tracefile=" + tracefile,
+      "+trace-output-format=" + std::to_string(format)};
+
+  uint64_t bytes = 0;
+  {
+    tracerv_t tracerv(sim,
+                      stream,
+                      addrs,
+                      0,
+                      args,
+                      0,
+                      STREAM_DEPTH,
+                      MAX_CORE_IPC,
+                      ClockInfo{"bench", 1, 1});
+    tracerv.init();
+    stream.set_source(0, trace_source);
+
+    while (state.keep_running())
+      tracerv.tick();
+    bytes = tracerv.bytes_pulled;
+  }
+  unlink((tracefile + "-C0").c_str());
+
+  uint64_t beats = bytes / beat_bytes;
+  state.set_items_processed(beats * MAX_CORE_IPC);
+  state.set_bytes_processed(bytes);
+  state.counters["beats/tick"] = (double)beats / state.iterations();
+}
+
+void BM_tracerv_human_readable(bench_state_t &state) { run(state, 0); }
+void BM_tracerv_binary(bench_state_t &state) { run(state, 1); }
+
+} // namespace
+
+BRIDGE_BENCHMARK(BM_tracerv_human_readable);
+BRIDGE_BENCHMARK(BM_tracerv_binary);
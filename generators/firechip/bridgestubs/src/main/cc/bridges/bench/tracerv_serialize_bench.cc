@@ -0,0 +1,173 @@
+// See LICENSE for license details
+
+#include "bridge_bench.h"
+
+#include "bridges/tracerv.h"
+#include "bridges/tracerv/trace_tracker.h"
+#include "bridges/tracerv/tracerv_processing.h"
+
+#include <functional>
+#include <memory>
+#include <random>
+
+/**
+ * Throughput of tracerv_t::serialize() and TraceTracker::addInstruction(),
+ * independent of any stream, on synthetic trace beats. Parameters:
+ *
+ *   --set=ipc=<1..7>            retired instructions per beat (7)
+ *   --set=valid-density=<0..1>  probability an instruction slot is valid (1)
+ *   --set=vmlinux=<elf>         resolve fireperf labels against a real
+ *                               kernel instead of a synthetic symbol table
+ *   --set=functions=<n>         size of the synthetic symbol table (4096)
+ *   --set=trace-out=<file>      where the trace goes (/dev/null)
+ */
+namespace {
+
+constexpr size_t BEAT_WORDS = 8;
+constexpr size_t NUM_BEATS = 1 << 14;
+constexpr uint64_t VALID = 1ULL << 63;
+constexpr uint64_t KERNEL_BASE = 0xffffffff80000000ULL;
+// Trace slots hold the low 40 bits of the PC, sign-extended on decode
+constexpr uint64_t IADDR_MASK = (1ULL << 40) - 1;
+
+struct synthetic_binary_t {
+  subroutine_map table;
+  std::vector<std::pair<uint64_t, uint64_t>> ranges;
+  uint64_t limit = KERNEL_BASE;
+};
+
+/// Kernel-like symbol table: functions of 16B to 1KiB, with a callsite
+/// roughly every 64B.
+synthetic_binary_t make_binary(size_t functions, std::mt19937_64 &rng) {
+  synthetic_binary_t bin;
+  std::uniform_int_distribution<uint64_t> size(4, 256);
+  for (size_t i = 0; i < functions; i++) {
+    uint64_t start = bin.limit;
+    uint64_t end = start + 4 * size(rng);
+    std::string name = "fn" + std::to_string(i);
+    auto &sub = bin.table
+                    .emplace(std::piecewise_construct,
+                             std::forward_as_tuple(start),
+                             std::forward_as_tuple(name.c_str(), end, true))
+                    .first->second;
+    for (uint64_t pc = start + 64; pc < end; pc += 64)
+      sub.callsites.emplace_back(pc);
+    bin.ranges.emplace_back(start, end);
+    bin.limit = end;
+  }
+  return bin;
+}
+
+/**
+ * Beats in the layout of the TracerV stream: a cycle count followed by up to
+ * seven instruction slots. PCs run through basic blocks of random functions,
+ * with the odd excursion to userspace.
+ */
+std::vector<uint64_t> make_beats(const synthetic_binary_t &bin,
+                                 unsigned ipc,
+                                 double density,
+                                 std::mt19937_64 &rng) {
+  std::vector<uint64_t> beats(NUM_BEATS * BEAT_WORDS, 0);
+  std::bernoulli_distribution valid(density);
+  std::bernoulli_distribution userspace(0.05);
+  std::uniform_int_distribution<size_t> pick(0, bin.ranges.size() - 1);
+  std::uniform_int_distribution<unsigned> block(1, 16);
+
+  uint64_t pc = 0, block_left = 0, cycle = 0;
+  for (size_t b = 0; b < NUM_BEATS; b++) {
+    uint64_t *beat = &beats[b * BEAT_WORDS];
+    beat[0] = cycle;
+    cycle += 1 + block(rng) % 4;
+    for (unsigned q = 0; q < ipc; q++) {
+      if (!valid(rng))
+        continue;
+      if (block_left == 0) {
+        auto &range = bin.ranges[pick(rng)];
+        pc = userspace(rng) ? 0x10000 + 4 * block(rng) : range.first;
+        block_left = block(rng);
+      }
+      beat[1 + q] = VALID | (pc & IADDR_MASK);
+      pc += 4;
+      block_left--;
+    }
+  }
+  return beats;
+}
+
+struct serialize_mode_t {
+  bool human_readable;
+  bool test_output;
+  bool fireperf;
+};
+
+void run(bench_state_t &state, const serialize_mode_t &mode) {
+  std::mt19937_64 rng(0);
+  unsigned ipc = (unsigned)bench_param("ipc", 7.0);
+  ipc = std::min(7u, std::max(1u, ipc));
+  double density = bench_param("valid-density", 1.0);
+  auto bin = make_binary((size_t)bench_param("functions", 4096.0), rng);
+  auto beats = make_beats(bin, ipc, density, rng);
+
+  std::string out = bench_param("trace-out", "/dev/null");
+  FILE *tracefile = fopen(out.c_str(), "w");
+  if (!tracefile) {
+    fprintf(stderr, "Could not open %s\n", out.c_str());
+    abort();
+  }
+
+  std::unique_ptr<TraceTracker> tracker;
+  std::function<void(uint64_t, uint64_t)> addInstruction;
+  if (mode.fireperf) {
+    std::string vmlinux = bench_param("vmlinux", "");
+    if (vmlinux.empty()) {
+      tracker = std::make_unique<TraceTracker>(
+          new ObjdumpedBinary(bin.table, KERNEL_BASE, bin.limit), tracefile);
+    } else {
+      tracker = std::make_unique<TraceTracker>(vmlinux, tracefile);
+    }
+    addInstruction = [&](uint64_t iaddr, uint64_t cycle) {
+      tracker->addInstruction(iaddr, cycle);
+    };
+  }
+
+  const size_t bytes = beats.size() * sizeof(uint64_t);
+  while (state.keep_running()) {
+    tracerv_t::serialize(beats.data(),
+                         bytes,
+                         tracefile,
+                         addInstruction,
+                         ipc,
+                         mode.human_readable,
+                         mode.test_output,
+                         mode.fireperf);
+  }
+  fclose(tracefile);
+
+  uint64_t insns = 0;
+  for (size_t i = 0; i < beats.size(); i += BEAT_WORDS)
+    for (unsigned q = 0; q < ipc; q++)
+      insns += (beats[i + 1 + q] & VALID) != 0;
+  state.set_items_processed(insns * state.iterations());
+  state.set_bytes_processed(bytes * state.iterations());
+  state.counters["insns/beat"] = (double)insns / NUM_BEATS;
+}
+
+void BM_tracerv_serialize_human_readable(bench_state_t &state) {
+  run(state, serialize_mode_t{true, false, false});
+}
+void BM_tracerv_serialize_binary(bench_state_t &state) {
+  run(state, serialize_mode_t{false, false, false});
+}
+void BM_tracerv_serialize_test(bench_state_t &state) {
+  run(state, serialize_mode_t{false, true, false});
+}
+void BM_tracerv_serialize_fireperf(bench_state_t &state) {
+  run(state, serialize_mode_t{false, false, true});
+}
+
+} // namespace
+
+BRIDGE_BENCHMARK(BM_tracerv_serialize_human_readable);
+BRIDGE_BENCHMARK(BM_tracerv_serialize_binary);
+BRIDGE_BENCHMARK(BM_tracerv_serialize_test);
+BRIDGE_BENCHMARK(BM_tracerv_serialize_fireperf);
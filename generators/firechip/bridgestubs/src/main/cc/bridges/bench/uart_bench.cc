@@ -0,0 +1,107 @@
+// See LICENSE for license details
+
+#include "bridge_bench.h"
+#include "mock_simif.h"
+#include "mock_stream_engine.h"
+
+#include "bridges/uart.h"
+
+#include <cstring>
+#include <deque>
+
+namespace {
+
+constexpr size_t CHARS_PER_ITER = 64;
+constexpr int STREAM_DEPTH = 128;
+
+std::vector<std::string> uart_args(bool buffered) {
+  std::vector<std::string> args = {"+uart-in0=/dev/null",
+                                   "+uart-out0=/dev/null"};
+  if (buffered)
+    args.push_back("+uart-buffered");
+  return args;
+}
+
+/**
+ * Model of the MMIO UART widget: output the target printed waits in a queue
+ * until the driver dequeues it, and the target never takes input.
+ */
+struct uart_widget_t {
+  std::deque<char> out;
+
+  void bind(mock_simif_t &sim, const UARTBRIDGEMODULE_struct &addrs) {
+    sim.on_read(addrs.out_valid, [this] { return !out.empty(); });
+    sim.on_read(addrs.out_bits, [this] { return (uint32_t)out.front(); });
+    sim.on_write(addrs.out_ready, [this](uint32_t) { out.pop_front(); });
+    sim.on_read(addrs.in_ready, [] { return 0u; });
+  }
+};
+
+/// The target prints CHARS_PER_ITER characters between two ticks.
+void run_mmio(bench_state_t &state, bool buffered) {
+  mock_simif_t sim(bench_options().mmio_latency_ns);
+  auto addrs = mock_mmio_addrs<UARTBRIDGEMODULE_struct>(0);
+  uart_t uart(sim, addrs, 0, uart_args(buffered));
+  uart_widget_t widget;
+  widget.bind(sim, addrs);
+  uart.init();
+
+  uint64_t chars = 0;
+  while (state.keep_running()) {
+    widget.out.insert(widget.out.end(), CHARS_PER_ITER, 'x');
+    uart.tick();
+    chars += CHARS_PER_ITER;
+  }
+
+  state.set_items_processed(chars);
+  state.counters["mmio/char"] =
+      (double)(uart.mmio_reads + uart.mmio_writes) / chars;
+  state.counters["batches/char"] = (double)uart.mmio_batches / chars;
+}
+
+/// The target keeps the to-host stream full of beats of UART_BEAT_CHARS.
+void run_stream(bench_state_t &state, bool buffered) {
+  constexpr size_t beat_bytes = streaming_bridge_driver_t::STREAM_WIDTH_BYTES;
+  mock_simif_t sim(bench_options().mmio_latency_ns);
+  mock_stream_engine_t stream(sim, 1, 1, STREAM_DEPTH * beat_bytes);
+  auto addrs = mock_mmio_addrs<UARTSTREAMBRIDGEMODULE_struct>(0);
+  uart_stream_t uart(sim,
+                     stream,
+                     addrs,
+                     0,
+                     uart_args(buffered),
+                     0,
+                     STREAM_DEPTH,
+                     0,
+                     STREAM_DEPTH);
+  uart.init();
+
+  stream.set_source(0, [](char *dest, size_t max_bytes) {
+    size_t bytes = max_bytes - max_bytes % beat_bytes;
+    for (size_t off = 0; off < bytes; off += beat_bytes) {
+      dest[off] = uart_stream_t::UART_BEAT_CHARS;
+      memset(dest + off + 1, 'x', uart_stream_t::UART_BEAT_CHARS);
+    }
+    return bytes;
+  });
+
+  while (state.keep_running())
+    uart.tick();
+
+  uint64_t beats = uart.bytes_pulled / beat_bytes;
+  state.set_items_processed(beats * uart_stream_t::UART_BEAT_CHARS);
+  state.set_bytes_processed(uart.bytes_pulled);
+  state.counters["beats/tick"] = (double)beats / state.iterations();
+}
+
+void BM_uart_mmio(bench_state_t &state) { run_mmio(state, false); }
+void BM_uart_mmio_buffered(bench_state_t &state) { run_mmio(state, true); }
+void BM_uart_stream(bench_state_t &state) { run_stream(state, false); }
+void BM_uart_stream_buffered(bench_state_t &state) { run_stream(state, true); }
+
+} // namespace
+
+BRIDGE_BENCHMARK(BM_uart_mmio);
+BRIDGE_BENCHMARK(BM_uart_mmio_buffered);
+BRIDGE_BENCHMARK(BM_uart_stream);
+BRIDGE_BENCHMARK(BM_uart_stream_buffered);
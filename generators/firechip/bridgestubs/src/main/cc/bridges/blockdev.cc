@@ -41,7 +41,7 @@ blockdev_t::blockdev_t(simif_t &sim,
                        const std::vector<std::string> &args,
                        uint32_t num_trackers,
                        uint32_t latency_bits)
-    : bridge_driver_t(sim, &KIND), mmio_addrs(mmio_addrs) {
+    : io_counted_t<bridge_driver_t>(sim, &KIND), mmio_addrs(mmio_addrs) {
   this->_file = nullptr;
   this->logfile = nullptr;
   _ntags = num_trackers;
@@ -301,35 +301,67 @@ void blockdev_t::handle_data(struct blkdev_data &data) {
   write_acks.push(data.tag);
 }
 
-/* Read all pending request data from the widget */
+/* Read all pending request data from the widget. The widget reports how many
+ * entries each queue holds, so they are all read and dequeued in one MMIO
+ * batch, which also reads the count again. */
 void blockdev_t::recv() {
   /* Read all pending requests from the widget */
-  while (read(mmio_addrs.bdev_req_valid)) {
-    /* Take a request from the FPGA and put it in SW processing queues */
-    struct blkdev_request req;
-    req.write = read(mmio_addrs.bdev_req_write);
-    req.offset = read(mmio_addrs.bdev_req_offset);
-    req.len = read(mmio_addrs.bdev_req_len);
-    req.tag = read(mmio_addrs.bdev_req_tag);
-    write(mmio_addrs.bdev_req_ready, true);
-    requests.push(req);
-    blkdev_printf("[disk] got req. write %x, offset %x, len %x, tag %x\n",
-                  req.write,
-                  req.offset,
-                  req.len,
-                  req.tag);
+  uint32_t count = read(mmio_addrs.bdev_req_count);
+  while (count > 0) {
+    /* Take the requests from the FPGA and put them in SW processing queues */
+    batch.clear();
+    for (uint32_t i = 0; i < count; i++) {
+      batch.read(mmio_addrs.bdev_req_write);
+      batch.read(mmio_addrs.bdev_req_offset);
+      batch.read(mmio_addrs.bdev_req_len);
+      batch.read(mmio_addrs.bdev_req_tag);
+      batch.write(mmio_addrs.bdev_req_ready, true);
+    }
+    const size_t count_h = batch.read(mmio_addrs.bdev_req_count);
+    submit(batch);
+
+    /* Each request took five operations: its fields, then the dequeue */
+    for (size_t h = 0; h < count_h; h += 5) {
+      struct blkdev_request req;
+      req.write = batch.result(h);
+      req.offset = batch.result(h + 1);
+      req.len = batch.result(h + 2);
+      req.tag = batch.result(h + 3);
+      requests.push(req);
+      blkdev_printf("[disk] got req. write %x, offset %x, len %x, tag %x\n",
+                    req.write,
+                    req.offset,
+                    req.len,
+                    req.tag);
+    }
+    count = batch.result(count_h);
   }
 
   /* Read all pending data beats from the widget */
-  while (read(mmio_addrs.bdev_data_valid)) {
-    /* Take a data chunk from the FPGA and put it in SW processing queues */
-    struct blkdev_data data;
-    data.data = (((uint64_t)read(mmio_addrs.bdev_data_data_upper)) << 32) |
-                (read(mmio_addrs.bdev_data_data_lower) & 0xFFFFFFFF);
-    data.tag = read(mmio_addrs.bdev_data_tag);
-    write(mmio_addrs.bdev_data_ready, true);
-    req_data.push(data);
-    blkdev_printf("[disk] got data. data %llx, tag %x\n", data.data, data.tag);
+  count = read(mmio_addrs.bdev_data_count);
+  while (count > 0) {
+    /* Take the data chunks from the FPGA and queue them for SW processing */
+    batch.clear();
+    for (uint32_t i = 0; i < count; i++) {
+      batch.read(mmio_addrs.bdev_data_data_upper);
+      batch.read(mmio_addrs.bdev_data_data_lower);
+      batch.read(mmio_addrs.bdev_data_tag);
+      batch.write(mmio_addrs.bdev_data_ready, true);
+    }
+    const size_t count_h = batch.read(mmio_addrs.bdev_data_count);
+    submit(batch);
+
+    /* Each beat took four operations: its fields, then the dequeue */
+    for (size_t h = 0; h < count_h; h += 4) {
+      struct blkdev_data data;
+      data.data = (((uint64_t)batch.result(h)) << 32) |
+                  (batch.result(h + 1) & 0xFFFFFFFF);
+      data.tag = batch.result(h + 2);
+      req_data.push(data);
+      blkdev_printf(
+          "[disk] got data. data %llx, tag %x\n", data.data, data.tag);
+    }
+    count = batch.result(count_h);
   }
 }
 
@@ -337,26 +369,52 @@ void blockdev_t::recv() {
  * possible In the event the widget buffers fill up; set resp_data_pending,
  * indicating that we must try again on the next tick() invocation */
 void blockdev_t::send() {
-  /* Return as many write acknowledgements as the blockdev widget can accept */
-  while (!write_acks.empty() && read(mmio_addrs.bdev_wack_ready)) {
-    uint32_t tag = write_acks.front();
-    write(mmio_addrs.bdev_wack_tag, tag);
-    write(mmio_addrs.bdev_wack_valid, true);
-    blkdev_printf("[disk] sending W ack. tag %x\n", tag);
-    write_acks.pop();
+  /* Return as many write acknowledgements as the blockdev widget can accept.
+   * The widget reports how many its queue can take, so that many are
+   * enqueued in one MMIO batch, which also reads the free space again if
+   * acks remain. */
+  uint32_t space = write_acks.empty() ? 0 : read(mmio_addrs.bdev_wack_space);
+  while (space > 0) {
+    batch.clear();
+    for (; space > 0 && !write_acks.empty(); space--) {
+      uint32_t tag = write_acks.front();
+      batch.write(mmio_addrs.bdev_wack_tag, tag);
+      batch.write(mmio_addrs.bdev_wack_valid, true);
+      blkdev_printf("[disk] sending W ack. tag %x\n", tag);
+      write_acks.pop();
+    }
+    if (write_acks.empty()) {
+      submit(batch);
+      break;
+    }
+    const size_t space_h = batch.read(mmio_addrs.bdev_wack_space);
+    submit(batch);
+    space = batch.result(space_h);
   }
 
   /* Send as much read reponse data as as the blockdev widget will accept */
-  while (!read_responses.empty() && read(mmio_addrs.bdev_rresp_ready)) {
-    struct blkdev_data resp;
-    resp = read_responses.front();
-    write(mmio_addrs.bdev_rresp_data_upper, (resp.data >> 32) & 0xFFFFFFFF);
-    write(mmio_addrs.bdev_rresp_data_lower, resp.data & 0xFFFFFFFF);
-    write(mmio_addrs.bdev_rresp_tag, resp.tag);
-    write(mmio_addrs.bdev_rresp_valid, true);
-    blkdev_printf(
-        "[disk] sending R resp. data %llx, tag %x\n", resp.data, resp.tag);
-    read_responses.pop();
+  space = read_responses.empty() ? 0 : read(mmio_addrs.bdev_rresp_space);
+  while (space > 0) {
+    batch.clear();
+    for (; space > 0 && !read_responses.empty(); space--) {
+      struct blkdev_data resp;
+      resp = read_responses.front();
+      batch.write(mmio_addrs.bdev_rresp_data_upper,
+                  (resp.data >> 32) & 0xFFFFFFFF);
+      batch.write(mmio_addrs.bdev_rresp_data_lower, resp.data & 0xFFFFFFFF);
+      batch.write(mmio_addrs.bdev_rresp_tag, resp.tag);
+      batch.write(mmio_addrs.bdev_rresp_valid, true);
+      blkdev_printf(
+          "[disk] sending R resp. data %llx, tag %x\n", resp.data, resp.tag);
+      read_responses.pop();
+    }
+    if (read_responses.empty()) {
+      submit(batch);
+      break;
+    }
+    const size_t space_h = batch.read(mmio_addrs.bdev_rresp_space);
+    submit(batch);
+    space = batch.result(space_h);
   }
 
   /* Mark if finished */
@@ -373,7 +431,8 @@ bool blockdev_t::idle() {
 void blockdev_t::tick() {
 
   /* If there's nothing to do, early out and save a bunch of MMIO */
-  if (idle()) {
+  progress = !idle();
+  if (!progress) {
     return;
   }
 
@@ -6,6 +6,8 @@
 #include <stdio.h>
 #include <vector>
 
+#include "bridges/bridge_activity.h"
+#include "bridges/bridge_io_counters.h"
 #include "core/bridge_driver.h"
 
 struct BLOCKDEVBRIDGEMODULE_struct {
@@ -35,6 +37,10 @@ struct BLOCKDEVBRIDGEMODULE_struct {
   uint64_t bdev_reqs_pending;
   uint64_t bdev_wack_stalled;
   uint64_t bdev_rresp_stalled;
+  uint64_t bdev_req_count;
+  uint64_t bdev_data_count;
+  uint64_t bdev_rresp_space;
+  uint64_t bdev_wack_space;
 };
 
 #define SECTOR_SIZE 512
@@ -61,7 +67,8 @@ struct blkdev_write_tracker {
   uint64_t data[MAX_REQ_LEN * SECTOR_BEATS];
 };
 
-class blockdev_t : public bridge_driver_t {
+class blockdev_t : public io_counted_t<bridge_driver_t>,
+                   public bridge_activity_t {
 public:
   /// The identifier for the bridge type used for casts.
   static char KIND;
@@ -80,11 +87,14 @@ public:
   void init() override;
   void tick() override;
 
+  bool has_pending_work() const override { return resp_data_pending; }
+
   void send();
   void recv();
 
 private:
   const BLOCKDEVBRIDGEMODULE_struct mmio_addrs;
+  mmio_batch_t batch;
 
   // Set if, on the previous tick, we couldn't write back all of our response
   // data
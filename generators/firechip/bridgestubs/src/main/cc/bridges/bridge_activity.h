@@ -0,0 +1,41 @@
+// See LICENSE for license details
+#ifndef __BRIDGE_ACTIVITY_H
+#define __BRIDGE_ACTIVITY_H
+
+#include <cstdint>
+
+/**
+ * Optional interface through which a bridge driver reports how busy it is to
+ * the simulation loop's bridge scheduler.
+ *
+ * After every tick() the scheduler checks made_progress(): bridges that made
+ * none are polled exponentially less often, bridges with pending work are
+ * ticked ahead of the others. Bridges that do not implement this interface
+ * are ticked on every pass, as before.
+ */
+class bridge_activity_t {
+public:
+  virtual ~bridge_activity_t() = default;
+
+  /// True if the last tick() moved data or otherwise made progress.
+  bool made_progress() const { return progress; }
+
+  /// True if the bridge holds work it could not finish in the last tick()
+  /// (e.g. a streaming bridge with more data to drain).
+  virtual bool has_pending_work() const { return false; }
+
+  /// Passes the scheduler may skip before polling an idle bridge again, or
+  /// 0 to leave the choice to the scheduler's backoff.
+  virtual uint32_t poll_hint() const { return 0; }
+
+  /// True if the last tick() found one of the bridge's streams filled to its
+  /// full depth, i.e. the host is what limits the target.
+  bool stream_saturated() const { return saturated; }
+
+protected:
+  // Set by tick() implementations
+  bool progress = true;
+  bool saturated = false;
+};
+
+#endif // __BRIDGE_ACTIVITY_H
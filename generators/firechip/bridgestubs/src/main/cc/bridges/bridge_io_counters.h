@@ -0,0 +1,84 @@
+// See LICENSE for license details
+#ifndef __BRIDGE_IO_COUNTERS_H
+#define __BRIDGE_IO_COUNTERS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "bridges/mmio_batch.h"
+
+/**
+ * MMIO and stream traffic issued by a bridge driver, for profiling.
+ *
+ * Counters are only written by the thread ticking the bridge and may be
+ * sampled from any thread.
+ */
+class bridge_io_counters_t {
+public:
+  virtual ~bridge_io_counters_t() = default;
+
+  std::atomic<uint64_t> mmio_reads{0};
+  std::atomic<uint64_t> mmio_writes{0};
+  std::atomic<uint64_t> mmio_batches{0};
+  std::atomic<uint64_t> bytes_pulled{0};
+  std::atomic<uint64_t> bytes_pushed{0};
+
+protected:
+  // Single writer, so no locked read-modify-write is needed
+  static void bump(std::atomic<uint64_t> &counter, uint64_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n,
+                  std::memory_order_relaxed);
+  }
+};
+
+/**
+ * Wraps a bridge driver base class (bridge_driver_t or
+ * streaming_bridge_driver_t) so that every read, write, pull and push the
+ * driver issues is counted, and adds submit() for batched MMIO (see
+ * mmio_batch_t). Drivers derive from io_counted_t<base> instead of base.
+ */
+template <typename base_t>
+class io_counted_t : public base_t, public bridge_io_counters_t {
+public:
+  using base_t::base_t;
+
+protected:
+  // Only instantiated when used, so pull/push are fine on MMIO-only bases
+  uint32_t read(size_t addr) {
+    bump(mmio_reads, 1);
+    return base_t::read(addr);
+  }
+
+  void write(size_t addr, uint32_t data) {
+    bump(mmio_writes, 1);
+    base_t::write(addr, data);
+  }
+
+  /// Issues the batch through the platform's executor (see
+  /// mmio_batch_t::set_executor()), which records the results of its reads.
+  void submit(mmio_batch_t &batch) {
+    if (batch.empty())
+      return;
+    bump(mmio_batches, 1);
+    bump(mmio_reads, batch.reads());
+    bump(mmio_writes, batch.size() - batch.reads());
+    mmio_batch_t::executor()(this->simif, batch);
+  }
+
+  size_t
+  pull(unsigned idx, void *dest, size_t num_bytes, size_t threshold_bytes) {
+    size_t bytes = base_t::pull(idx, dest, num_bytes, threshold_bytes);
+    bump(bytes_pulled, bytes);
+    return bytes;
+  }
+
+  size_t
+  push(unsigned idx, void *src, size_t num_bytes, size_t threshold_bytes) {
+    size_t bytes = base_t::push(idx, src, num_bytes, threshold_bytes);
+    bump(bytes_pushed, bytes);
+    return bytes;
+  }
+};
+
+#endif // __BRIDGE_IO_COUNTERS_H
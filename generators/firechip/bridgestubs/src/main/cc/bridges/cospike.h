@@ -4,12 +4,13 @@
 
 #include "bridges/cospike/mem_pool.h"
 #include "bridges/cospike/thread_pool.h"
+#include "bridges/bridge_io_counters.h"
 #include "core/bridge_driver.h"
 #include <string>
 #include <vector>
 #include <zlib.h>
 
-class cospike_t : public streaming_bridge_driver_t {
+class cospike_t : public io_counted_t<streaming_bridge_driver_t> {
 public:
   /// The identifier for the bridge type used for casts.
   static char KIND;
@@ -2,12 +2,14 @@
 #ifndef __DMIBRIDGE_H
 #define __DMIBRIDGE_H
 
+#include "bridges/bridge_activity.h"
+#include "bridges/bridge_io_counters.h"
+#include "bridges/fesvr_host.h"
 #include "bridges/serial_data.h"
 #include "core/bridge_driver.h"
 
 class loadmem_t;
 class firesim_dtm_t;
-class firesim_loadmem_t;
 
 struct DMIBRIDGEMODULE_struct {
   uint64_t in_bits_addr;
@@ -24,7 +26,8 @@ struct DMIBRIDGEMODULE_struct {
   uint64_t start;
 };
 
-class dmibridge_t : public bridge_driver_t {
+class dmibridge_t : public io_counted_t<bridge_driver_t>,
+                    public bridge_activity_t {
 public:
   /// The identifier for the bridge type used for casts.
   static char KIND;
@@ -36,41 +39,25 @@ public:
               const std::vector<std::string> &args,
               bool has_mem,
               int64_t mem_host_offset);
-  ~dmibridge_t();
   virtual void init();
   virtual void tick();
   virtual bool terminate();
   virtual int exit_code();
+  virtual void finish();
 
 private:
   const DMIBRIDGEMODULE_struct mmio_addrs;
-  loadmem_t &loadmem_widget;
+  mmio_batch_t batch;
 
-  firesim_dtm_t *fesvr;
-  bool has_mem;
-  // host memory offset based on the number of memory models and their size
-  int64_t mem_host_offset;
-  // Number of target cycles between fesvr interactions
+  // fesvr, program loading and the choice of step size
+  fesvr_host_t<firesim_dtm_t> host;
+  // Step size the widget is programmed with
   uint32_t step_size;
-  // Same as step_size but value during initial programing phase
-  uint32_t loading_step_size;
-  // During the initial program phase speed up when FESVR is called
-  // (i.e. speed up program loading when loadmem isn't/can't be used)
-  bool fast_fesvr;
-  // Delay n ticks to avoid race-condition where target reset resets the bridge
-  // state and drops xacts
-  uint32_t wait_ticks;
-
-  // Arguments passed to firesim_dtm.
-  char **dmi_argv = nullptr;
-  int dmi_argc;
 
   // Tell the widget to start enqueuing tokens
   void go();
-
-  void handle_loadmem_read(firesim_loadmem_t loadmem);
-  void handle_loadmem_write(firesim_loadmem_t loadmem);
-  void dmi_bypass_via_loadmem();
+  // Reprograms the widget if the step size changed
+  void set_step_size(uint32_t step);
 };
 
 #endif // __DMIBRIDGE_H
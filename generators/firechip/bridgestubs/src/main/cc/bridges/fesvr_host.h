@@ -0,0 +1,92 @@
+// See LICENSE for license details
+#ifndef __FESVR_HOST_H
+#define __FESVR_HOST_H
+
+#include "bridges/fesvr_step_controller.h"
+#include "bridges/loadmem_image.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class loadmem_t;
+struct firesim_loadmem_t;
+
+/**
+ * Host side of a fesvr-driven bridge, shared by the TSI (see tsi_host_t) and
+ * DMI (dmibridge_t) drivers: fesvr and its target arguments, the program
+ * image fast path, loadmem requests, and the choice of step size.
+ *
+ * fesvr_t is firesim_tsi_t or firesim_dtm_t. Their headers cannot be
+ * included together, so the members are defined in fesvr_host_impl.h and
+ * instantiated once, next to the driver that includes the matching one.
+ */
+template <typename fesvr_t> class fesvr_host_t {
+public:
+  fesvr_host_t(const char *name,
+               const char *program,
+               loadmem_t &loadmem_widget,
+               int fesvrno,
+               const std::vector<std::string> &args,
+               bool has_mem,
+               int64_t mem_host_offset);
+  ~fesvr_host_t();
+
+  /// Builds fesvr, preloading the program image if requested. Must be called
+  /// from the thread that ticks the bridge. Returns the step size to program
+  /// before the first step.
+  uint32_t init();
+
+  fesvr_t &fesvr() { return *frontend; }
+
+  /// Returns true while the bridge should only restart the widget, to avoid
+  /// target reset dropping transactions.
+  bool skip_tick();
+
+  /// Serves fesvr's loadmem requests through the loadmem widget.
+  void serve_loadmem();
+
+  /// Accounts for the step that just completed and returns the step size for
+  /// the next one. drained is true if none of fesvr's requests are still
+  /// waiting to be sent to the target; program loading only ends then.
+  uint32_t next_step_size(bool drained);
+
+  void finish();
+
+private:
+  const char *name;
+  loadmem_t &loadmem_widget;
+
+  fesvr_t *frontend = nullptr;
+  bool has_mem;
+  // host memory offset based on the number of memory models and their size
+  int64_t mem_host_offset;
+  // Number of target cycles between fesvr interactions
+  uint32_t step_size;
+  // Picks step_size for each window once program loading is done
+  fesvr_step_controller_t step_controller;
+  // Same as step_size but value during initial programing phase
+  uint32_t loading_step_size;
+  // During the initial program phase speed up when FESVR is called
+  // (i.e. speed up program loading when loadmem isn't/can't be used)
+  bool fast_fesvr;
+  // Delay n ticks to avoid race-condition where target reset resets the bridge
+  // state and drops xacts
+  uint32_t wait_ticks;
+  // Program image fast path: write a cached, pre-flattened image of the
+  // program directly into target memory instead of streaming it via fesvr
+  loadmem_image_args_t loadmem_image_args;
+
+  // Arguments passed to fesvr.
+  char **fesvr_argv = nullptr;
+  int fesvr_argc;
+
+  // Writes the program image into target memory before fesvr starts
+  void preload_image();
+
+  // Helper functions to handoff fesvr requests to the loadmem unit
+  void handle_loadmem_read(firesim_loadmem_t loadmem);
+  void handle_loadmem_write(firesim_loadmem_t loadmem);
+};
+
+#endif // __FESVR_HOST_H
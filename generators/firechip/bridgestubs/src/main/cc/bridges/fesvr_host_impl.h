@@ -0,0 +1,238 @@
+// See LICENSE for license details
+#ifndef __FESVR_HOST_IMPL_H
+#define __FESVR_HOST_IMPL_H
+
+// Member definitions of fesvr_host_t. Include only after the header of the
+// fesvr_t being instantiated.
+
+#include "bridges/fesvr_host.h"
+#include "bridges/loadmem.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <gmp.h>
+#include <sstream>
+
+template <typename fesvr_t>
+fesvr_host_t<fesvr_t>::fesvr_host_t(const char *name,
+                                    const char *program,
+                                    loadmem_t &loadmem_widget,
+                                    int fesvrno,
+                                    const std::vector<std::string> &args,
+                                    bool has_mem,
+                                    int64_t mem_host_offset)
+    : name(name), loadmem_widget(loadmem_widget), has_mem(has_mem),
+      mem_host_offset(mem_host_offset) {
+
+  const std::string num_equals = std::to_string(fesvrno) + std::string("=");
+  const std::string prog_arg = std::string("+prog") + num_equals;
+  std::vector<std::string> args_vec;
+  args_vec.push_back(program);
+
+  // This particular selection is vestigial. You may change it freely.
+  step_size = 2004765L;
+
+  // During the initial program phase speed up when FESVR is called
+  // (i.e. speed up program loading when loadmem isn't/can't be used)
+  // (disabled by default)
+  fast_fesvr = false;
+
+  // This particular selection is correlated to the amount of reset cycles.
+  // It should be larger than the reset period.
+  wait_ticks = 8;
+
+  // This particular selection is vestigial. You may change it freely.
+  // This * wait_ticks is should be larger than the reset period.
+  loading_step_size = fast_fesvr ? 8 : step_size;
+
+  for (auto &arg : args) {
+    if (arg.find("+fesvr-step-size=") == 0) {
+      step_size = atoi(arg.c_str() + 17);
+    }
+    if (arg.find("+fesvr-enable-early-fast") == 0) {
+      fast_fesvr = true;
+    }
+    if (arg.find("+fesvr-wait-ticks=") == 0) {
+      wait_ticks = atoi(arg.c_str() + 18);
+    }
+    loadmem_image_args.parse(arg);
+    step_controller.parse(arg);
+    if (arg.find(prog_arg) == 0) {
+      std::string clean_target_args =
+          const_cast<char *>(arg.c_str()) + prog_arg.length();
+
+      std::istringstream ss(clean_target_args);
+      std::string token;
+      while (std::getline(ss, token, ' ')) {
+        args_vec.push_back(token);
+      }
+    } else if (arg.find(std::string("+prog")) == 0) {
+      // Eliminate arguments for other fesvrs
+    } else {
+      args_vec.push_back(arg);
+    }
+  }
+
+  step_controller.set_step_size(step_size);
+  step_size = step_controller.get_step_size();
+
+  int argc_count = args_vec.size() - 1;
+  fesvr_argv = new char *[args_vec.size()];
+  for (size_t i = 0; i < args_vec.size(); ++i) {
+    fesvr_argv[i] = new char[args_vec[i].size() + 1];
+    std::strcpy(fesvr_argv[i], args_vec[i].c_str());
+  }
+
+  // debug for command line arguments
+  printf("command line for program %d. argc=%d:\n", fesvrno, argc_count);
+  for (int i = 0; i < argc_count; i++) {
+    printf("%s ", fesvr_argv[i + 1]);
+  }
+  printf("\n");
+
+  fesvr_argc = argc_count + 1;
+}
+
+template <typename fesvr_t> fesvr_host_t<fesvr_t>::~fesvr_host_t() {
+  if (frontend)
+    delete frontend;
+  if (fesvr_argv) {
+    for (int i = 0; i < fesvr_argc; ++i) {
+      if (fesvr_argv[i])
+        delete[] fesvr_argv[i];
+    }
+    delete[] fesvr_argv;
+  }
+}
+
+template <typename fesvr_t> uint32_t fesvr_host_t<fesvr_t>::init() {
+  // `ucontext` used by fesvr cannot be created in one thread and resumed in
+  // another. To ensure that the fesvr process is on the correct thread, it is
+  // built here, as the bridge constructor may be invoked from a thread other
+  // than the one it will run on later in meta-simulations.
+  frontend = new fesvr_t(fesvr_argc, fesvr_argv, has_mem);
+  if (loadmem_image_args.enabled()) {
+    preload_image();
+  }
+  if (fast_fesvr) {
+    printf("%s::init set FESVR step-size to %" PRIu32 " initially\n",
+           name,
+           loading_step_size);
+    return loading_step_size;
+  }
+  frontend->set_loaded_in_target(true); // pre-set to unblock reset
+  return step_size;
+}
+
+template <typename fesvr_t> bool fesvr_host_t<fesvr_t>::skip_tick() {
+  if (wait_ticks == 0)
+    return false;
+  wait_ticks -= 1;
+  printf("%s::tick skipping tick\n", name);
+  return true;
+}
+
+template <typename fesvr_t>
+uint32_t fesvr_host_t<fesvr_t>::next_step_size(bool drained) {
+  if (!fast_fesvr) {
+    step_size = step_controller.next(!frontend->take_idled());
+    return step_size;
+  }
+  if (frontend->loaded_in_host() && drained) {
+    frontend->set_loaded_in_target(true); // done w/ firesim loading
+    printf("%s::tick reverting FESVR step-size to %" PRIu32 "\n",
+           name,
+           step_size);
+    fast_fesvr = false; // only write this user-defined step size once
+    return step_size;
+  }
+  return loading_step_size;
+}
+
+template <typename fesvr_t> void fesvr_host_t<fesvr_t>::finish() {
+  step_controller.report(stdout, name);
+}
+
+template <typename fesvr_t> void fesvr_host_t<fesvr_t>::preload_image() {
+  if (!has_mem) {
+    fprintf(
+        stderr, "%s: +loadmem-image requires a target with loadmem\n", name);
+    return;
+  }
+  const auto &targs = frontend->target_args();
+  if (targs.empty()) {
+    fprintf(stderr, "%s: +loadmem-image requires a target program\n", name);
+    abort();
+  }
+  auto image = loadmem_image_t::get(
+      loadmem_image_args.cache_dir, targs[0], loadmem_image_args.blobs);
+  loadmem_image_write(loadmem_widget, *image, mem_host_offset);
+  frontend->set_program_preloaded(true);
+}
+
+template <typename fesvr_t>
+void fesvr_host_t<fesvr_t>::handle_loadmem_read(firesim_loadmem_t loadmem) {
+  assert(loadmem.size % sizeof(uint32_t) == 0);
+  assert(has_mem);
+  // Loadmem reads are in granularities of the width of the FPGA-DRAM bus
+  mpz_t buf;
+  mpz_init(buf);
+  while (loadmem.size > 0) {
+    loadmem_widget.read_mem(loadmem.addr + mem_host_offset, buf);
+
+    // If the read word is 0; mpz_export seems to return an array with length 0
+    size_t beats_requested =
+        (loadmem.size / sizeof(uint32_t) > loadmem_widget.get_mem_data_chunk())
+            ? loadmem_widget.get_mem_data_chunk()
+            : loadmem.size / sizeof(uint32_t);
+    // The number of beats exported from buf; may be less than beats requested.
+    size_t non_zero_beats;
+    uint32_t *data = (uint32_t *)mpz_export(
+        NULL, &non_zero_beats, -1, sizeof(uint32_t), 0, 0, buf);
+    size_t nz = std::min(non_zero_beats, beats_requested);
+    frontend->send_loadmem_words(data, nz);
+    for (size_t j = nz; j < beats_requested; j++) {
+      frontend->send_loadmem_word(0);
+    }
+    loadmem.size -= beats_requested * sizeof(uint32_t);
+  }
+  mpz_clear(buf);
+  // Switch back to fesvr for it to process read data
+  frontend->switch_to_host();
+}
+
+template <typename fesvr_t>
+void fesvr_host_t<fesvr_t>::handle_loadmem_write(firesim_loadmem_t loadmem) {
+  assert(loadmem.size <= 4096);
+  assert(has_mem);
+  static char buf[4096]; // size chosen empirically based on chunk sizes
+  frontend->recv_loadmem_data(buf, loadmem.size);
+  mpz_t data;
+  mpz_init(data);
+  mpz_import(data,
+             (loadmem.size + sizeof(uint32_t) - 1) / sizeof(uint32_t),
+             -1,
+             sizeof(uint32_t),
+             0,
+             0,
+             buf);
+  loadmem_widget.write_mem_chunk(
+      loadmem.addr + mem_host_offset, data, loadmem.size);
+  mpz_clear(data);
+}
+
+template <typename fesvr_t> void fesvr_host_t<fesvr_t>::serve_loadmem() {
+  firesim_loadmem_t loadmem;
+  while (frontend->has_loadmem_reqs()) {
+    // Check for reads first as they preceed a narrow write;
+    if (frontend->recv_loadmem_read_req(loadmem))
+      handle_loadmem_read(loadmem);
+    if (frontend->recv_loadmem_write_req(loadmem))
+      handle_loadmem_write(loadmem);
+  }
+}
+
+#endif // __FESVR_HOST_IMPL_H
@@ -0,0 +1,93 @@
+// See LICENSE for license details
+
+#include "fesvr_step_controller.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+
+bool fesvr_step_controller_t::parse(const std::string &arg) {
+  if (arg.find("+fesvr-adaptive-step") == 0) {
+    is_adaptive = true;
+    return true;
+  }
+  if (arg.find("+fesvr-step-min=") == 0) {
+    min_step = std::max(1, atoi(arg.c_str() + 16));
+    return true;
+  }
+  if (arg.find("+fesvr-step-max=") == 0) {
+    max_step = strtoul(arg.c_str() + 16, nullptr, 10);
+    return true;
+  }
+  if (arg.find("+fesvr-step-grow-after=") == 0) {
+    grow_after = atoi(arg.c_str() + 23);
+    return true;
+  }
+  if (arg.find("+fesvr-step-shrink-after=") == 0) {
+    shrink_after = atoi(arg.c_str() + 25);
+    return true;
+  }
+  return false;
+}
+
+uint32_t fesvr_step_controller_t::clamp(uint32_t step) const {
+  if (!is_adaptive)
+    return step;
+  if (step < min_step)
+    return min_step;
+  if (step > max_step)
+    return max_step;
+  return step;
+}
+
+uint32_t fesvr_step_controller_t::next(bool active) {
+  int bucket = 0;
+  while (bucket < NUM_BUCKETS - 1 && (1ULL << bucket) < step_size)
+    bucket++;
+  windows[bucket]++;
+  cycles[bucket] += step_size;
+
+  if (!is_adaptive)
+    return step_size;
+
+  if (active) {
+    // Back off quickly: a target request being serviced means more are
+    // likely to follow (console output, syscall sequences).
+    idle_windows = 0;
+    if (++active_windows >= shrink_after)
+      step_size = clamp(step_size / 4);
+  } else {
+    active_windows = 0;
+    if (++idle_windows >= grow_after)
+      step_size = clamp(step_size > max_step / 2 ? max_step : step_size * 2);
+  }
+  return step_size;
+}
+
+void fesvr_step_controller_t::report(FILE *file, const char *name) const {
+  uint64_t total_windows = 0, total_cycles = 0;
+  for (int i = 0; i < NUM_BUCKETS; i++) {
+    total_windows += windows[i];
+    total_cycles += cycles[i];
+  }
+  if (total_windows == 0)
+    return;
+
+  fprintf(file,
+          "%s: fesvr step size histogram (%s, %" PRIu64 " windows, %" PRIu64
+          " cycles)\n",
+          name,
+          is_adaptive ? "adaptive" : "fixed",
+          total_windows,
+          total_cycles);
+  for (int i = 0; i < NUM_BUCKETS; i++) {
+    if (windows[i] == 0)
+      continue;
+    fprintf(file,
+            "  step <= %10" PRIu64 ": %10" PRIu64
+            " windows (%5.1f%% of cycles)\n",
+            (uint64_t)1 << i,
+            windows[i],
+            100.0 * cycles[i] / total_cycles);
+  }
+}
@@ -0,0 +1,57 @@
+// See LICENSE for license details
+#ifndef __FESVR_STEP_CONTROLLER_H
+#define __FESVR_STEP_CONTROLLER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**
+ * Chooses the number of target cycles between fesvr interactions.
+ *
+ * In fixed mode (the default) the step size never changes. In adaptive mode
+ * (+fesvr-adaptive-step) the step is quartered for every window in a run of
+ * active windows, so console- and syscall-heavy phases stay responsive, and
+ * doubled for every window in a run of idle windows, so compute phases run
+ * with as few host interactions as possible. A window is active if fesvr did
+ * not go idle in it; a lone active window is fesvr's periodic tohost poll and
+ * is ignored by requiring a run of at least +fesvr-step-shrink-after windows.
+ *
+ * Every chosen step is recorded in a log2 histogram reported at exit.
+ */
+class fesvr_step_controller_t {
+public:
+  /// Consumes the controller's plusargs. Returns true if arg was consumed.
+  bool parse(const std::string &arg);
+
+  bool adaptive() const { return is_adaptive; }
+  uint32_t get_step_size() const { return step_size; }
+  void set_step_size(uint32_t step) { step_size = clamp(step); }
+
+  /// Accounts for the window that just completed and returns the step size
+  /// to use for the next one.
+  uint32_t next(bool active);
+
+  void report(FILE *file, const char *name) const;
+
+private:
+  static constexpr int NUM_BUCKETS = 33;
+
+  bool is_adaptive = false;
+  uint32_t step_size = 0;
+  uint32_t min_step = 1024;
+  uint32_t max_step = 1U << 26;
+  // Length of the current run of idle / active windows
+  uint32_t idle_windows = 0;
+  uint32_t active_windows = 0;
+  // Run lengths after which the step starts growing / shrinking
+  uint32_t grow_after = 2;
+  uint32_t shrink_after = 2;
+
+  uint64_t windows[NUM_BUCKETS] = {};
+  uint64_t cycles[NUM_BUCKETS] = {};
+
+  uint32_t clamp(uint32_t step) const;
+};
+
+#endif // __FESVR_STEP_CONTROLLER_H
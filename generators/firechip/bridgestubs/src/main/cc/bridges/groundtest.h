@@ -2,13 +2,16 @@
 #ifndef __GROUNDTEST_H
 #define __GROUNDTEST_H
 
+#include "bridges/bridge_activity.h"
+#include "bridges/bridge_io_counters.h"
 #include "core/bridge_driver.h"
 
 struct GROUNDTESTBRIDGEMODULE_struct {
   uint64_t success;
 };
 
-class groundtest_t : public bridge_driver_t {
+class groundtest_t : public io_counted_t<bridge_driver_t>,
+                     public bridge_activity_t {
 public:
   /// The identifier for the bridge type used for casts.
   static char KIND;
@@ -0,0 +1,280 @@
+// See LICENSE for license details
+
+#include "loadmem_image.h"
+#include "bridges/loadmem.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#include <elf.h>
+#include <gmp.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char IMAGE_MAGIC[8] = {'F', 'S', 'L', 'M', 'I', 'M', 'G', '1'};
+
+static std::vector<char> read_file(const std::string &path) {
+  FILE *f = fopen(path.c_str(), "rb");
+  if (!f) {
+    fprintf(stderr, "loadmem-image: could not open %s\n", path.c_str());
+    abort();
+  }
+  std::vector<char> contents;
+  char buf[1 << 16];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    contents.insert(contents.end(), buf, buf + n);
+  fclose(f);
+  return contents;
+}
+
+// 64-bit FNV-1a; only used to name cache entries.
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t len) {
+  const unsigned char *p = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < len; i++) {
+    hash ^= p[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+std::unique_ptr<loadmem_image_t>
+loadmem_image_t::get(const std::string &cache_dir,
+                     const std::string &elf,
+                     const std::vector<blob_t> &blobs) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  std::vector<char> contents = read_file(elf);
+  hash = fnv1a(hash, contents.data(), contents.size());
+  for (auto &blob : blobs) {
+    contents = read_file(blob.path);
+    hash = fnv1a(hash, contents.data(), contents.size());
+    hash = fnv1a(hash, &blob.addr, sizeof(blob.addr));
+  }
+
+  char name[32];
+  snprintf(name, sizeof(name), "%016" PRIx64 ".img", hash);
+  std::string path = cache_dir + "/" + name;
+
+  auto image = std::make_unique<loadmem_image_t>();
+  if (image->load(path)) {
+    printf("loadmem-image: using cached image %s\n", path.c_str());
+    return image;
+  }
+
+  image->build(elf, blobs);
+  mkdir(cache_dir.c_str(), 0755);
+  image->save(path);
+  printf("loadmem-image: built image %s (%" PRIu64 " bytes)\n",
+         path.c_str(),
+         image->total_bytes());
+  return image;
+}
+
+uint64_t loadmem_image_t::total_bytes() const {
+  uint64_t total = 0;
+  for (auto &extent : extents)
+    total += extent.data.size();
+  return total;
+}
+
+template <typename ehdr_t, typename phdr_t, typename place_fn_t>
+static void place_segments(const std::string &path,
+                           const std::vector<char> &contents,
+                           place_fn_t &place) {
+  if (contents.size() < sizeof(ehdr_t)) {
+    fprintf(stderr, "loadmem-image: %s is truncated\n", path.c_str());
+    abort();
+  }
+  ehdr_t ehdr;
+  memcpy(&ehdr, contents.data(), sizeof(ehdr));
+  for (size_t i = 0; i < ehdr.e_phnum; i++) {
+    phdr_t phdr;
+    size_t off = ehdr.e_phoff + i * sizeof(phdr);
+    if (off + sizeof(phdr) > contents.size()) {
+      fprintf(stderr, "loadmem-image: %s is truncated\n", path.c_str());
+      abort();
+    }
+    memcpy(&phdr, contents.data() + off, sizeof(phdr));
+    if (phdr.p_type != PT_LOAD)
+      continue;
+    if (phdr.p_offset + phdr.p_filesz > contents.size() ||
+        phdr.p_filesz > phdr.p_memsz) {
+      fprintf(stderr,
+              "loadmem-image: segment %zu of %s is malformed\n",
+              i,
+              path.c_str());
+      abort();
+    }
+    // Match fesvr: segments are placed at their physical address and the
+    // memsz - filesz tail is zero-filled.
+    place(phdr.p_paddr, contents.data() + phdr.p_offset, phdr.p_filesz);
+    place(phdr.p_paddr + phdr.p_filesz, nullptr, phdr.p_memsz - phdr.p_filesz);
+  }
+}
+
+void loadmem_image_t::build(const std::string &elf_path,
+                            const std::vector<blob_t> &blobs) {
+  // Pages are collected in a map so segments may arrive in any order and
+  // share pages; they are coalesced into extents at the end.
+  std::map<uint64_t, std::vector<char>> pages;
+  auto place = [&](uint64_t addr, const char *src, uint64_t len) {
+    while (len > 0) {
+      uint64_t page = addr & ~(IMAGE_PAGE_BYTES - 1);
+      uint64_t off = addr - page;
+      uint64_t n = std::min(len, IMAGE_PAGE_BYTES - off);
+      auto &data = pages[page];
+      if (data.empty())
+        data.resize(IMAGE_PAGE_BYTES, 0);
+      if (src) {
+        memcpy(data.data() + off, src, n);
+        src += n;
+      } else {
+        memset(data.data() + off, 0, n);
+      }
+      addr += n;
+      len -= n;
+    }
+  };
+
+  std::vector<char> contents = read_file(elf_path);
+  if (contents.size() < EI_NIDENT ||
+      memcmp(contents.data(), ELFMAG, SELFMAG) != 0) {
+    fprintf(stderr, "loadmem-image: %s is not an ELF\n", elf_path.c_str());
+    abort();
+  }
+  if (contents[EI_CLASS] == ELFCLASS64) {
+    place_segments<Elf64_Ehdr, Elf64_Phdr>(elf_path, contents, place);
+  } else {
+    place_segments<Elf32_Ehdr, Elf32_Phdr>(elf_path, contents, place);
+  }
+
+  for (auto &blob : blobs) {
+    contents = read_file(blob.path);
+    place(blob.addr, contents.data(), contents.size());
+  }
+
+  extents.clear();
+  for (auto &[page, data] : pages) {
+    if (extents.empty() ||
+        extents.back().addr + extents.back().data.size() != page) {
+      extents.push_back(extent_t{page, {}});
+    }
+    auto &extent = extents.back().data;
+    extent.insert(extent.end(), data.begin(), data.end());
+  }
+}
+
+bool loadmem_image_t::load(const std::string &path) {
+  FILE *f = fopen(path.c_str(), "rb");
+  if (!f)
+    return false;
+
+  struct stat st;
+  char magic[sizeof(IMAGE_MAGIC)];
+  uint64_t count;
+  bool ok = fstat(fileno(f), &st) == 0 &&
+            fread(magic, sizeof(magic), 1, f) == 1 &&
+            !memcmp(magic, IMAGE_MAGIC, sizeof(magic)) &&
+            fread(&count, sizeof(count), 1, f) == 1;
+  for (uint64_t i = 0; ok && i < count; i++) {
+    uint64_t header[2];
+    ok = fread(header, sizeof(header), 1, f) == 1;
+    // A truncated or corrupt entry is a cache miss, not a huge allocation.
+    long pos = ok ? ftell(f) : -1;
+    ok = pos >= 0 && pos <= st.st_size &&
+         header[1] <= uint64_t(st.st_size - pos);
+    if (!ok)
+      break;
+    extent_t extent{header[0], std::vector<char>(header[1])};
+    ok = fread(extent.data.data(), 1, header[1], f) == header[1];
+    extents.push_back(std::move(extent));
+  }
+  fclose(f);
+
+  if (!ok) {
+    fprintf(
+        stderr, "loadmem-image: ignoring corrupt image %s\n", path.c_str());
+    extents.clear();
+  }
+  return ok;
+}
+
+void loadmem_image_t::save(const std::string &path) const {
+  // Write to a temporary and rename, so concurrent simulations sharing a
+  // cache never observe a partially written image.
+  std::string tmp = path + ".tmp" + std::to_string(getpid());
+  FILE *f = fopen(tmp.c_str(), "wb");
+  if (!f) {
+    fprintf(
+        stderr, "loadmem-image: could not cache image at %s\n", tmp.c_str());
+    return;
+  }
+  uint64_t count = extents.size();
+  bool ok = fwrite(IMAGE_MAGIC, sizeof(IMAGE_MAGIC), 1, f) == 1 &&
+            fwrite(&count, sizeof(count), 1, f) == 1;
+  for (auto &extent : extents) {
+    uint64_t header[2] = {extent.addr, extent.data.size()};
+    ok = ok && fwrite(header, sizeof(header), 1, f) == 1 &&
+         fwrite(extent.data.data(), 1, extent.data.size(), f) ==
+             extent.data.size();
+  }
+  ok = (fclose(f) == 0) && ok;
+  if (!ok || rename(tmp.c_str(), path.c_str())) {
+    fprintf(
+        stderr, "loadmem-image: could not cache image at %s\n", path.c_str());
+    unlink(tmp.c_str());
+  }
+}
+
+void loadmem_image_write(loadmem_t &loadmem_widget,
+                         const loadmem_image_t &image,
+                         int64_t mem_host_offset) {
+  mpz_t data;
+  mpz_init(data);
+  for (auto &extent : image.get_extents()) {
+    for (size_t off = 0; off < extent.data.size();
+         off += loadmem_image_t::IMAGE_PAGE_BYTES) {
+      size_t len = std::min<size_t>(loadmem_image_t::IMAGE_PAGE_BYTES,
+                                    extent.data.size() - off);
+      mpz_import(data,
+                 len / sizeof(uint32_t),
+                 -1,
+                 sizeof(uint32_t),
+                 0,
+                 0,
+                 extent.data.data() + off);
+      loadmem_widget.write_mem_chunk(
+          extent.addr + off + mem_host_offset, data, len);
+    }
+  }
+  mpz_clear(data);
+}
+
+bool loadmem_image_args_t::parse(const std::string &arg) {
+  const std::string image_arg = "+loadmem-image=";
+  const std::string blob_arg = "+loadmem-image-blob=";
+
+  if (arg.find(image_arg) == 0) {
+    cache_dir = arg.substr(image_arg.length());
+    return true;
+  }
+  if (arg.find(blob_arg) == 0) {
+    std::string spec = arg.substr(blob_arg.length());
+    size_t at = spec.rfind('@');
+    if (at == std::string::npos) {
+      fprintf(stderr,
+              "Invalid %s%s, expected <file>@<addr>\n",
+              blob_arg.c_str(),
+              spec.c_str());
+      abort();
+    }
+    blobs.push_back(loadmem_image_t::blob_t{
+        spec.substr(0, at), strtoull(spec.c_str() + at + 1, nullptr, 16)});
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,73 @@
+// See LICENSE for license details
+#ifndef __LOADMEM_IMAGE_H
+#define __LOADMEM_IMAGE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class loadmem_t;
+
+/**
+ * Flattened, page-aligned memory image of a target program.
+ *
+ * The image is built from the PT_LOAD segments of an ELF plus any number of
+ * raw blobs (e.g. an initramfs or a DTB) placed at fixed addresses. Only pages
+ * touched by a segment or blob are kept, coalesced into contiguous extents.
+ *
+ * Built images are cached on disk under a name derived from a hash of every
+ * input, so subsequent runs of the same payload skip the ELF walk entirely.
+ */
+class loadmem_image_t {
+public:
+  static constexpr uint64_t IMAGE_PAGE_BYTES = 4096;
+
+  struct blob_t {
+    std::string path;
+    uint64_t addr;
+  };
+
+  struct extent_t {
+    uint64_t addr;
+    std::vector<char> data;
+  };
+
+  /// Returns the cached image for the inputs, building (and caching) it if
+  /// it is not present in cache_dir yet.
+  static std::unique_ptr<loadmem_image_t> get(const std::string &cache_dir,
+                                              const std::string &elf,
+                                              const std::vector<blob_t> &blobs);
+
+  const std::vector<extent_t> &get_extents() const { return extents; }
+  uint64_t total_bytes() const;
+
+private:
+  std::vector<extent_t> extents;
+
+  void build(const std::string &elf, const std::vector<blob_t> &blobs);
+  bool load(const std::string &path);
+  void save(const std::string &path) const;
+};
+
+/// Writes every extent of the image into target memory through the loadmem
+/// widget, bypassing fesvr entirely.
+void loadmem_image_write(loadmem_t &loadmem_widget,
+                         const loadmem_image_t &image,
+                         int64_t mem_host_offset);
+
+/**
+ * Command-line options controlling the image fast path of a fesvr bridge:
+ *   +loadmem-image=<cache dir>               enable, caching images in dir
+ *   +loadmem-image-blob=<file>@<hex addr>    extra payload (repeatable)
+ */
+struct loadmem_image_args_t {
+  std::string cache_dir;
+  std::vector<loadmem_image_t::blob_t> blobs;
+
+  bool enabled() const { return !cache_dir.empty(); }
+  /// Returns true if arg was consumed.
+  bool parse(const std::string &arg);
+};
+
+#endif // __LOADMEM_IMAGE_H
@@ -0,0 +1,14 @@
+// See LICENSE for license details
+
+#include "mmio_batch.h"
+#include "core/simif.h"
+
+void mmio_batch_t::issue_in_order(simif_t &simif, mmio_batch_t &batch) {
+  for (auto &op : batch.ops) {
+    if (op.is_read) {
+      op.data = simif.read(op.addr);
+    } else {
+      simif.write(op.addr, op.data);
+    }
+  }
+}
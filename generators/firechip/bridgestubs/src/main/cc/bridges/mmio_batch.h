@@ -0,0 +1,84 @@
+// See LICENSE for license details
+#ifndef __MMIO_BATCH_H
+#define __MMIO_BATCH_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class simif_t;
+
+/**
+ * A sequence of MMIO reads and writes submitted to the target in one go.
+ *
+ * Drivers queue operations, hand the batch to io_counted_t::submit() and then
+ * look up the values of the queued reads. Operations are issued in the order
+ * they were queued, so a batch may freely mix dependent writes and reads
+ * (e.g. dequeue entries, then read how many the queue still holds).
+ *
+ * Batches are issued by an executor, selected once per process. The default
+ * makes one blocking simif_t access per operation; a platform whose host link
+ * can overlap accesses (bursts, several outstanding reads) installs its own
+ * with set_executor() before any bridge ticks. Drivers should only queue
+ * reads whose result they would need regardless, so the default does no
+ * extra work.
+ */
+class mmio_batch_t {
+public:
+  struct op_t {
+    size_t addr;
+    // Value written, or the result of a read
+    uint32_t data;
+    bool is_read;
+  };
+
+  /// Issues the operations of a batch in order and stores the result of each
+  /// read in its data field.
+  using executor_t = void (*)(simif_t &simif, mmio_batch_t &batch);
+
+  static void set_executor(executor_t executor) { current = executor; }
+  static executor_t executor() { return current; }
+  /// The default executor.
+  static void issue_in_order(simif_t &simif, mmio_batch_t &batch);
+
+  /// Queues a write of data to addr.
+  void write(size_t addr, uint32_t data) {
+    ops.push_back(op_t{addr, data, false});
+  }
+
+  /// Queues a read of addr and returns the handle of its result. Handles
+  /// number the operations of the batch in the order they were queued.
+  size_t read(size_t addr) {
+    ops.push_back(op_t{addr, 0, true});
+    n_reads++;
+    return ops.size() - 1;
+  }
+
+  /// Result of a queued read, valid once the batch has been submitted.
+  uint32_t result(size_t handle) const {
+    assert(ops[handle].is_read);
+    return ops[handle].data;
+  }
+
+  bool empty() const { return ops.empty(); }
+  size_t size() const { return ops.size(); }
+  size_t reads() const { return n_reads; }
+
+  /// The queued operations, for executors.
+  std::vector<op_t> &operations() { return ops; }
+
+  /// Drops every operation, keeping the storage for the next batch.
+  void clear() {
+    ops.clear();
+    n_reads = 0;
+  }
+
+private:
+  std::vector<op_t> ops;
+  size_t n_reads = 0;
+
+  static inline executor_t current = issue_in_order;
+};
+
+#endif // __MMIO_BATCH_H
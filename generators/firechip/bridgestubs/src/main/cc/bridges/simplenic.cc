@@ -60,7 +60,8 @@ simplenic_t::simplenic_t(simif_t &sim,
                          const int stream_to_cpu_depth,
                          const int stream_from_cpu_idx,
                          const int stream_from_cpu_depth)
-    : streaming_bridge_driver_t(sim, stream, &KIND), mmio_addrs(mmio_addrs),
+    : io_counted_t<streaming_bridge_driver_t>(sim, stream, &KIND),
+      mmio_addrs(mmio_addrs),
       stream_to_cpu_idx(stream_to_cpu_idx),
       stream_from_cpu_idx(stream_from_cpu_idx) {
   const char *niclogfile = nullptr;
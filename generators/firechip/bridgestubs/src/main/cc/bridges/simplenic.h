@@ -5,6 +5,7 @@
 
 #include <vector>
 
+#include "bridges/bridge_io_counters.h"
 #include "core/bridge_driver.h"
 #include "core/stream_engine.h"
 
@@ -20,7 +21,7 @@ struct SIMPLENICBRIDGEMODULE_struct {
   uint64_t done;
 };
 
-class simplenic_t final : public streaming_bridge_driver_t {
+class simplenic_t final : public io_counted_t<streaming_bridge_driver_t> {
 public:
   /// The identifier for the bridge type used for casts.
   static char KIND;
@@ -0,0 +1,31 @@
+// See LICENSE for license details
+#ifndef __THREAD_SAFE_BRIDGE_H
+#define __THREAD_SAFE_BRIDGE_H
+
+#include <chrono>
+
+/**
+ * Interface for bridge drivers that can hand the host-side processing of
+ * their stream data to a dedicated thread (see bridge_threads_t).
+ *
+ * tick() always runs on the simulation loop's thread: pull(), push() and
+ * pull_flush() read and write stream engine registers, and MMIO must not run
+ * concurrently with the loop's own. Once offload() was called, tick() only
+ * moves stream data into host buffers and queues them for process(), which
+ * runs on the worker thread. process() must touch no MMIO and no state that
+ * tick() still uses.
+ */
+class thread_safe_bridge_t {
+public:
+  virtual ~thread_safe_bridge_t() = default;
+
+  /// Makes tick() queue its buffers for process() from now on. Called once,
+  /// on the main thread, before the first tick.
+  virtual void offload() = 0;
+
+  /// Processes the buffers queued by tick(), waiting up to timeout for one if
+  /// none is queued. Returns false if there was nothing to process.
+  virtual bool process(std::chrono::microseconds timeout) = 0;
+};
+
+#endif // __THREAD_SAFE_BRIDGE_H
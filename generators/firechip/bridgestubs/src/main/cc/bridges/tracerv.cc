@@ -8,6 +8,7 @@
 #include <cinttypes>
 #include <climits>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
 #include <fcntl.h>
@@ -32,7 +33,8 @@ tracerv_t::tracerv_t(simif_t &sim,
                      int stream_depth,
                      unsigned int max_core_ipc,
                      const ClockInfo &clock_info)
-    : streaming_bridge_driver_t(sim, stream, &KIND), mmio_addrs(mmio_addrs),
+    : io_counted_t<streaming_bridge_driver_t>(sim, stream, &KIND),
+      mmio_addrs(mmio_addrs),
       stream_idx(stream_idx), stream_depth(stream_depth),
       max_core_ipc(max_core_ipc), clock_info(clock_info) {
   const char *tracefilename = nullptr;
@@ -150,6 +152,10 @@ tracerv_t::~tracerv_t() {
   if (this->tracefile) {
     fclose(this->tracefile);
   }
+  for (auto &batch : free_batches)
+    free(batch.data);
+  for (auto &batch : full_batches)
+    free(batch.data);
 }
 
 void tracerv_t::init() {
@@ -215,6 +221,70 @@ size_t tracerv_t::process_tokens(int num_beats, int minimum_batch_beats) {
   page_aligned_sized_array(OUTBUF, this->stream_depth * STREAM_WIDTH_BYTES);
   auto bytes_received =
       pull(this->stream_idx, OUTBUF, maximum_batch_bytes, minimum_batch_bytes);
+  serialize_tokens(OUTBUF, bytes_received);
+  return bytes_received;
+}
+
+size_t tracerv_t::queue_tokens(int num_beats, int minimum_batch_beats) {
+  batches_exhausted = num_free == 0;
+  if (batches_exhausted)
+    return 0;
+  batch_t batch;
+  {
+    std::lock_guard<std::mutex> guard(batch_lock);
+    batch = free_batches.back();
+    free_batches.pop_back();
+    --num_free;
+  }
+  batch.bytes = pull(this->stream_idx,
+                     batch.data,
+                     num_beats * STREAM_WIDTH_BYTES,
+                     minimum_batch_beats * STREAM_WIDTH_BYTES);
+  {
+    std::lock_guard<std::mutex> guard(batch_lock);
+    if (batch.bytes > 0) {
+      full_batches.push_back(batch);
+    } else {
+      free_batches.push_back(batch);
+      ++num_free;
+    }
+  }
+  if (batch.bytes > 0)
+    batch_ready.notify_one();
+  return batch.bytes;
+}
+
+void tracerv_t::offload() {
+  size_t bytes = this->stream_depth * STREAM_WIDTH_BYTES;
+  // Buffers handed to pull() are page aligned, as OUTBUF is
+  bytes = (bytes + 4095) & ~size_t(4095);
+  for (size_t i = 0; i < NUM_BATCHES; i++) {
+    free_batches.push_back(batch_t{(char *)aligned_alloc(4096, bytes), 0});
+  }
+  num_free = NUM_BATCHES;
+  offloaded = true;
+}
+
+bool tracerv_t::process(std::chrono::microseconds timeout) {
+  batch_t batch;
+  {
+    std::unique_lock<std::mutex> guard(batch_lock);
+    if (!batch_ready.wait_for(
+            guard, timeout, [&] { return !full_batches.empty(); }))
+      return false;
+    batch = full_batches.front();
+    full_batches.pop_front();
+  }
+  serialize_tokens(batch.data, batch.bytes);
+  {
+    std::lock_guard<std::mutex> guard(batch_lock);
+    free_batches.push_back(batch);
+    ++num_free;
+  }
+  return true;
+}
+
+void tracerv_t::serialize_tokens(const char *buf, size_t bytes_received) {
   // check that a tracefile exists (one is enough) since the manager
   // does not create a tracefile when trace_enable is disabled, but the
   // TracerV bridge still exists, and no tracefile is created by default.
@@ -227,7 +297,7 @@ size_t tracerv_t::process_tokens(int num_beats, int minimum_batch_beats) {
                                  std::placeholders::_1,
                                  std::placeholders::_2);
     }
-    serialize((uint64_t *)OUTBUF,
+    serialize((const uint64_t *)buf,
               bytes_received,
               tracefile,
               addInstruction,
@@ -236,7 +306,6 @@ size_t tracerv_t::process_tokens(int num_beats, int minimum_batch_beats) {
               test_output,
               fireperf);
   }
-  return bytes_received;
 }
 
 void tracerv_t::serialize(
@@ -307,13 +376,23 @@ void tracerv_t::write_header(FILE *file) {
 }
 
 void tracerv_t::tick() {
+  size_t bytes_received = 0;
   if (this->trace_enabled) {
-    process_tokens(this->stream_depth, this->stream_depth);
+    bytes_received =
+        offloaded ? queue_tokens(this->stream_depth, this->stream_depth)
+                  : process_tokens(this->stream_depth, this->stream_depth);
   }
+  progress = bytes_received > 0;
+  // With every batch still queued, the worker is what limits the target
+  saturated = bytes_received == this->stream_depth * STREAM_WIDTH_BYTES ||
+              (offloaded && batches_exhausted);
 }
 
 // Pull in any remaining tokens and flush them to file
 void tracerv_t::flush() {
+  // Batches the worker left behind come first
+  while (process(std::chrono::microseconds(0)))
+    ;
   pull_flush(stream_idx);
   while (this->trace_enabled && (process_tokens(this->stream_depth, 0) > 0))
     ;
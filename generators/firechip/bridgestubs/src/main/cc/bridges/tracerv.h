@@ -2,9 +2,16 @@
 #ifndef __TRACERV_H
 #define __TRACERV_H
 
+#include "bridges/bridge_activity.h"
+#include "bridges/bridge_io_counters.h"
+#include "bridges/thread_safe_bridge.h"
 #include "core/bridge_driver.h"
 #include "core/clock_info.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <mutex>
 #include <vector>
 
 class TraceTracker;
@@ -28,7 +35,9 @@ struct TRACERVBRIDGEMODULE_struct {
   uint64_t triggerSelector;
 };
 
-class tracerv_t final : public streaming_bridge_driver_t {
+class tracerv_t final : public io_counted_t<streaming_bridge_driver_t>,
+                        public bridge_activity_t,
+                        public thread_safe_bridge_t {
 public:
   /// The identifier for the bridge type used for casts.
   static char KIND;
@@ -47,6 +56,11 @@ public:
   virtual void init();
   virtual void tick();
   virtual void finish() { flush(); };
+  // A full batch was drained on the last tick, so more is likely waiting
+  bool has_pending_work() const override { return saturated; }
+
+  void offload() override;
+  bool process(std::chrono::microseconds timeout) override;
 
   static void serialize(const uint64_t *OUTBUF,
                         size_t bytes_received,
@@ -98,7 +112,28 @@ private:
   std::string dwarf_file_name;
   bool fireperf = false;
 
+  // A buffer of tokens pulled by tick() and waiting for process()
+  struct batch_t {
+    char *data;
+    size_t bytes;
+  };
+  static constexpr size_t NUM_BATCHES = 4;
+
+  // Set by offload(): tick() only pulls, process() serializes
+  bool offloaded = false;
+  // Set by tick() if every batch was still waiting to be serialized
+  bool batches_exhausted = false;
+  std::mutex batch_lock;
+  std::condition_variable batch_ready;
+  std::vector<batch_t> free_batches;
+  std::deque<batch_t> full_batches;
+  // Size of free_batches, checked by tick() without taking the lock
+  std::atomic<size_t> num_free{0};
+
   size_t process_tokens(int num_beats, int minium_batch_beats);
+  // As process_tokens, but queues the tokens for process()
+  size_t queue_tokens(int num_beats, int minimum_batch_beats);
+  void serialize_tokens(const char *buf, size_t bytes_received);
   int beats_available_stable();
 
 public:
@@ -2,8 +2,11 @@
 
 //#define TRACETRACKER_LOG_PC_REGION
 
-TraceTracker::TraceTracker(std::string binary_with_dwarf, FILE *tracefile) {
-  this->bin_dump = new ObjdumpedBinary(binary_with_dwarf);
+TraceTracker::TraceTracker(std::string binary_with_dwarf, FILE *tracefile)
+    : TraceTracker(new ObjdumpedBinary(binary_with_dwarf), tracefile) {}
+
+TraceTracker::TraceTracker(ObjdumpedBinary *bin_dump, FILE *tracefile) {
+  this->bin_dump = bin_dump;
   this->tracefile = tracefile;
 }
 
@@ -59,6 +59,7 @@ private:
 
 public:
   TraceTracker(std::string binary_with_dwarf, FILE *tracefile);
+  TraceTracker(ObjdumpedBinary *bin_dump, FILE *tracefile);
   void addInstruction(uint64_t inst_addr, uint64_t cycle);
 };
 
@@ -24,6 +24,22 @@ ObjdumpedBinary::ObjdumpedBinary(std::string binaryWithDwarf) {
   }
   close(fd);
 
+  for (const auto &kv : table) {
+    kv.second.print(kv.first);
+  }
+  populate(table, base, limit);
+  printf("\n");
+}
+
+ObjdumpedBinary::ObjdumpedBinary(const subroutine_map &table,
+                                 uint64_t base,
+                                 uint64_t limit) {
+  populate(table, base, limit);
+}
+
+void ObjdumpedBinary::populate(const subroutine_map &table,
+                               uint64_t base,
+                               uint64_t limit) {
   if (!table.empty()) {
     uint64_t addr = table.begin()->first;
     this->baseaddr = (addr < base) ? addr : base;
@@ -40,8 +56,6 @@ ObjdumpedBinary::ObjdumpedBinary(std::string binaryWithDwarf) {
     uint64_t pc_low = kv.first;
     const subroutine_t &sub = kv.second;
 
-    sub.print(pc_low);
-
     size_t start = pc_low - this->baseaddr;
     size_t end = (sub.pc_end > pc_low) ? (sub.pc_end - this->baseaddr) : start;
     if (this->progtext.size() < end) {
@@ -138,7 +152,6 @@ ObjdumpedBinary::ObjdumpedBinary(std::string binaryWithDwarf) {
 
     prev = sub.pc_end ? nullptr : entry;
   }
-  printf("\n");
 
   // Propagate previous unbounded label to end of image
   if (prev) {
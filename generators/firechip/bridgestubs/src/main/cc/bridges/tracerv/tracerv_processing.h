@@ -10,6 +10,8 @@
 
 #include <ctype.h>
 
+#include "tracerv_dwarf.h"
+
 class Instr {
 public:
   std::string instval;
@@ -40,7 +42,13 @@ class ObjdumpedBinary {
 
 public:
   ObjdumpedBinary(std::string binaryWithDwarf);
+  // build from a subroutine table that was already extracted (or made up,
+  // e.g. for benchmarking), covering [base, limit)
+  ObjdumpedBinary(const subroutine_map &table, uint64_t base, uint64_t limit);
   Instr *getInstrFromAddr(uint64_t lookupaddress);
+
+private:
+  void populate(const subroutine_map &table, uint64_t base, uint64_t limit);
 };
 
 #endif // __TRACERV_PROCESSING_H
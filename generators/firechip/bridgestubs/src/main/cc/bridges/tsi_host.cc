@@ -0,0 +1,34 @@
+// See LICENSE for license details
+
+#include "tsi_host.h"
+#include "fesvr/firesim_tsi.h"
+
+#include "bridges/fesvr_host_impl.h"
+
+template class fesvr_host_t<firesim_tsi_t>;
+
+tsi_host_t::tsi_host_t(const char *name,
+                       loadmem_t &loadmem_widget,
+                       int tsino,
+                       const std::vector<std::string> &args,
+                       bool has_mem,
+                       int64_t mem_host_offset)
+    : fesvr_host_t(name,
+                   "firesim_tsi",
+                   loadmem_widget,
+                   tsino,
+                   args,
+                   has_mem,
+                   mem_host_offset) {}
+
+bool tsi_host_t::drained(bool words_pending) {
+  return !words_pending && !fesvr().data_available();
+}
+
+void tsi_host_t::service(bool words_pending) {
+  // Punt to FESVR
+  if (drained(words_pending)) {
+    fesvr().tick();
+  }
+  serve_loadmem();
+}
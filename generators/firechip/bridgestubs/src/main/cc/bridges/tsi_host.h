@@ -0,0 +1,33 @@
+// See LICENSE for license details
+#ifndef __TSI_HOST_H
+#define __TSI_HOST_H
+
+#include "bridges/fesvr_host.h"
+
+class firesim_tsi_t;
+
+/**
+ * Host side of a TSI bridge, shared by the MMIO (tsibridge_t) and streaming
+ * (tsistreambridge_t) drivers.
+ *
+ * The drivers only move TSI words to and from the widget and program the
+ * step sizes this picks.
+ */
+class tsi_host_t : public fesvr_host_t<firesim_tsi_t> {
+public:
+  tsi_host_t(const char *name,
+             loadmem_t &loadmem_widget,
+             int tsino,
+             const std::vector<std::string> &args,
+             bool has_mem,
+             int64_t mem_host_offset);
+
+  /// True if neither fesvr nor the driver has words left for the target.
+  bool drained(bool words_pending);
+
+  /// Runs fesvr once drained, then serves fesvr's loadmem requests through
+  /// the loadmem widget.
+  void service(bool words_pending);
+};
+
+#endif // __TSI_HOST_H
@@ -2,12 +2,13 @@
 #ifndef __TSIBRIDGE_H
 #define __TSIBRIDGE_H
 
+#include "bridges/bridge_activity.h"
+#include "bridges/bridge_io_counters.h"
 #include "bridges/serial_data.h"
+#include "bridges/tsi_host.h"
 #include "core/bridge_driver.h"
 
 class loadmem_t;
-class firesim_tsi_t;
-class firesim_loadmem_t;
 
 struct TSIBRIDGEMODULE_struct {
   uint64_t in_bits;
@@ -19,9 +20,12 @@ struct TSIBRIDGEMODULE_struct {
   uint64_t step_size;
   uint64_t done;
   uint64_t start;
+  uint64_t out_count;
+  uint64_t in_space;
 };
 
-class tsibridge_t : public bridge_driver_t {
+class tsibridge_t : public io_counted_t<bridge_driver_t>,
+                    public bridge_activity_t {
 public:
   /// The identifier for the bridge type used for casts.
   static char KIND;
@@ -33,45 +37,28 @@ public:
               const std::vector<std::string> &args,
               bool has_mem,
               int64_t mem_host_offset);
-  ~tsibridge_t();
   virtual void init();
   virtual void tick();
   virtual bool terminate();
   virtual int exit_code();
+  virtual void finish();
 
 private:
   const TSIBRIDGEMODULE_struct mmio_addrs;
-  loadmem_t &loadmem_widget;
+  mmio_batch_t batch;
 
-  firesim_tsi_t *fesvr;
-  bool has_mem;
-  // host memory offset based on the number of memory models and their size
-  int64_t mem_host_offset;
-  // Number of target cycles between fesvr interactions
+  // fesvr, program loading and the choice of step size
+  tsi_host_t host;
+  // Step size the widget is programmed with
   uint32_t step_size;
-  // Same as step_size but value during initial programing phase
-  uint32_t loading_step_size;
-  // During the initial program phase speed up when FESVR is called
-  // (i.e. speed up program loading when loadmem isn't/can't be used)
-  bool fast_fesvr;
-  // Delay n ticks to avoid race-condition where target reset resets the bridge
-  // state and drops xacts
-  uint32_t wait_ticks;
-
-  // Arguments passed to firesim_tsi.
-  char **tsi_argv = nullptr;
-  int tsi_argc;
 
   // Tell the widget to start enqueuing tokens
   void go();
+  // Reprograms the widget if the step size changed
+  void set_step_size(uint32_t step);
   // Moves data to and from the widget and fesvr
   void send(); // FESVR -> Widget
   void recv(); // Widget -> FESVR
-
-  // Helper functions to handoff fesvr requests to the loadmem unit
-  void handle_loadmem_read(firesim_loadmem_t loadmem);
-  void handle_loadmem_write(firesim_loadmem_t loadmem);
-  void tsi_bypass_via_loadmem();
 };
 
 #endif // __TSIBRIDGE_H
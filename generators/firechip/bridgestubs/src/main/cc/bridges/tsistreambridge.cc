@@ -0,0 +1,134 @@
+// See LICENSE for license details
+
+#include "tsistreambridge.h"
+#include "core/simif.h"
+#include "fesvr/firesim_tsi.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+char tsistreambridge_t::KIND;
+
+tsistreambridge_t::tsistreambridge_t(
+    simif_t &simif,
+    StreamEngine &stream,
+    loadmem_t &loadmem_widget,
+    const TSISTREAMBRIDGEMODULE_struct &mmio_addrs,
+    int tsino,
+    const std::vector<std::string> &args,
+    bool has_mem,
+    int64_t mem_host_offset,
+    int stream_to_cpu_idx,
+    int stream_to_cpu_depth,
+    int stream_from_cpu_idx,
+    int stream_from_cpu_depth)
+    : io_counted_t<streaming_bridge_driver_t>(simif, stream, &KIND),
+      mmio_addrs(mmio_addrs), stream_to_cpu_idx(stream_to_cpu_idx),
+      stream_to_cpu_depth(stream_to_cpu_depth),
+      stream_from_cpu_idx(stream_from_cpu_idx),
+      stream_from_cpu_depth(stream_from_cpu_depth),
+      host("tsistreambridge_t",
+           loadmem_widget,
+           tsino,
+           args,
+           has_mem,
+           mem_host_offset) {}
+
+void tsistreambridge_t::init() {
+  step_size = host.init();
+  write(mmio_addrs.step_size, step_size);
+  go();
+}
+
+void tsistreambridge_t::go() { write(mmio_addrs.start, 1); }
+
+void tsistreambridge_t::set_step_size(uint32_t step) {
+  if (step != step_size) {
+    step_size = step;
+    write(mmio_addrs.step_size, step_size);
+  }
+}
+
+void tsistreambridge_t::send() {
+  while (host.fesvr().data_available()) {
+    pending_words.push_back(host.fesvr().recv_word());
+  }
+  if (pending_words.empty())
+    return;
+
+  const size_t beat_bytes = STREAM_WIDTH_BYTES;
+  const size_t max_beats = std::min<size_t>(
+      stream_from_cpu_depth,
+      (pending_words.size() + TSI_BEAT_WORDS - 1) / TSI_BEAT_WORDS);
+  page_aligned_sized_array(INBUF, stream_from_cpu_depth * STREAM_WIDTH_BYTES);
+  uint32_t *beats = (uint32_t *)INBUF;
+  size_t packed = 0;
+  for (size_t beat = 0; beat < max_beats; beat++) {
+    uint32_t *words = beats + beat * (TSI_BEAT_WORDS + 1);
+    size_t count = std::min(TSI_BEAT_WORDS, pending_words.size() - packed);
+    memset(words, 0, beat_bytes);
+    words[0] = count;
+    std::copy_n(pending_words.begin() + packed, count, words + 1);
+    packed += count;
+  }
+
+  // Only drop the words of beats the stream actually accepted; the rest are
+  // retried on the next tick
+  size_t beats_sent =
+      push(stream_from_cpu_idx, INBUF, max_beats * beat_bytes, 0) / beat_bytes;
+  size_t words_sent = std::min(beats_sent * TSI_BEAT_WORDS, packed);
+  saturated |= beats_sent < max_beats;
+  pending_words.erase(pending_words.begin(),
+                      pending_words.begin() + words_sent);
+}
+
+void tsistreambridge_t::recv() {
+  page_aligned_sized_array(OUTBUF, stream_to_cpu_depth * STREAM_WIDTH_BYTES);
+  size_t bytes_received;
+  while ((bytes_received = pull(stream_to_cpu_idx,
+                                OUTBUF,
+                                stream_to_cpu_depth * STREAM_WIDTH_BYTES,
+                                0)) > 0) {
+    saturated |=
+        bytes_received == (size_t)stream_to_cpu_depth * STREAM_WIDTH_BYTES;
+    const uint32_t *beats = (const uint32_t *)OUTBUF;
+    for (size_t beat = 0; beat < bytes_received / STREAM_WIDTH_BYTES; beat++) {
+      const uint32_t *words = beats + beat * (TSI_BEAT_WORDS + 1);
+      assert(words[0] <= TSI_BEAT_WORDS);
+      for (uint32_t i = 0; i < words[0]; i++) {
+        host.fesvr().send_word(words[i + 1]);
+      }
+    }
+  }
+}
+
+void tsistreambridge_t::tick() {
+  saturated = false;
+  // Drain the target's words even mid-step so the to-host stream never fills
+  // up and stalls the widget
+  this->recv();
+  // Then check to see step_size tokens have been enqueued
+  progress = read(mmio_addrs.done);
+  if (!progress)
+    return;
+  // The last beat of a step may still be buffered in the stream
+  pull_flush(stream_to_cpu_idx);
+  this->recv();
+  if (host.skip_tick()) {
+    go();
+    return;
+  }
+  host.service(!pending_words.empty());
+  if (!terminate()) {
+    // Stream all the requests to the target
+    this->send();
+    set_step_size(host.next_step_size(host.drained(!pending_words.empty())));
+    go();
+  }
+}
+
+bool tsistreambridge_t::terminate() { return host.fesvr().done(); }
+int tsistreambridge_t::exit_code() { return host.fesvr().exit_code(); }
+
+void tsistreambridge_t::finish() { host.finish(); }
@@ -0,0 +1,82 @@
+// See LICENSE for license details
+#ifndef __TSISTREAMBRIDGE_H
+#define __TSISTREAMBRIDGE_H
+
+#include "bridges/bridge_activity.h"
+#include "bridges/bridge_io_counters.h"
+#include "bridges/tsi_host.h"
+#include "core/bridge_driver.h"
+#include "core/stream_engine.h"
+
+#include <deque>
+
+class loadmem_t;
+
+struct TSISTREAMBRIDGEMODULE_struct {
+  uint64_t step_size;
+  uint64_t done;
+  uint64_t start;
+};
+
+/**
+ * TSI bridge driver which exchanges TSI words with the target through the
+ * bridge streams rather than with one MMIO access per word.
+ *
+ * Each 512b stream beat holds a word count in its first 32b word followed by
+ * up to TSI_BEAT_WORDS TSI words, in both directions. MMIO is only used to
+ * program the step size and to start/poll each step.
+ */
+class tsistreambridge_t final : public io_counted_t<streaming_bridge_driver_t>,
+                                public bridge_activity_t {
+public:
+  /// The identifier for the bridge type used for casts.
+  static char KIND;
+
+  static constexpr size_t TSI_BEAT_WORDS =
+      STREAM_WIDTH_BYTES / sizeof(uint32_t) - 1;
+
+  tsistreambridge_t(simif_t &simif,
+                    StreamEngine &stream,
+                    loadmem_t &loadmem_widget,
+                    const TSISTREAMBRIDGEMODULE_struct &mmio_addrs,
+                    int tsino,
+                    const std::vector<std::string> &args,
+                    bool has_mem,
+                    int64_t mem_host_offset,
+                    int stream_to_cpu_idx,
+                    int stream_to_cpu_depth,
+                    int stream_from_cpu_idx,
+                    int stream_from_cpu_depth);
+
+  void init() override;
+  void tick() override;
+  bool terminate() override;
+  int exit_code() override;
+  void finish() override;
+
+private:
+  const TSISTREAMBRIDGEMODULE_struct mmio_addrs;
+
+  const int stream_to_cpu_idx;
+  const int stream_to_cpu_depth;
+  const int stream_from_cpu_idx;
+  const int stream_from_cpu_depth;
+
+  // fesvr, program loading and the choice of step size
+  tsi_host_t host;
+  // Step size the widget is programmed with
+  uint32_t step_size;
+
+  // Words produced by fesvr that did not fit in the from-host stream yet
+  std::deque<uint32_t> pending_words;
+
+  // Tell the widget to start enqueuing tokens
+  void go();
+  // Reprograms the widget if the step size changed
+  void set_step_size(uint32_t step);
+  // Moves data to and from the widget and fesvr, a beat at a time
+  void send(); // FESVR -> Widget
+  void recv(); // Widget -> FESVR
+};
+
+#endif // __TSISTREAMBRIDGE_H
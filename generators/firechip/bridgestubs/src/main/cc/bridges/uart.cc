@@ -1,10 +1,16 @@
 // See LICENSE for license details
 
 #include "uart.h"
+#include "bridges/uart_ring.h"
+#include "bridges/uart_socket.h"
 #include "core/simif.h"
 
+#include <atomic>
+#include <cassert>
+#include <chrono>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <thread>
 
 #ifndef _XOPEN_SOURCE
 #define _XOPEN_SOURCE
@@ -45,22 +51,46 @@ void sighand(int s) {
 
 /**
  * Helper class which links the UART stream to primitive streams.
+ *
+ * By default every character costs a read/write syscall on the tick path.
+ * Once start_io_thread() is called, get/put only touch in-memory rings and a
+ * background thread moves data between the rings and the fds in bulk.
  */
 class uart_fd_handler : public uart_handler {
 public:
+  static constexpr size_t RING_BYTES = 1 << 20;
+  static constexpr size_t IO_CHUNK_BYTES = 1 << 16;
+
   uart_fd_handler() = default;
   ~uart_fd_handler() override;
 
   std::optional<char> get() override;
   void put(char data) override;
 
+  void start_io_thread();
+
 protected:
   int inputfd;
   int outputfd;
   int loggingfd = 0;
+
+private:
+  std::unique_ptr<uart_ring_t> in_ring;
+  std::unique_ptr<uart_ring_t> out_ring;
+  std::thread io_thread;
+  std::atomic<bool> io_stop{false};
+
+  void io_loop();
 };
 
-uart_fd_handler::~uart_fd_handler() { close(this->loggingfd); }
+uart_fd_handler::~uart_fd_handler() {
+  if (io_thread.joinable()) {
+    // The I/O thread drains all buffered output before exiting
+    io_stop = true;
+    io_thread.join();
+  }
+  close(this->loggingfd);
+}
 
 std::optional<char> uart_fd_handler::get() {
   char inp;
@@ -73,6 +103,8 @@ std::optional<char> uart_fd_handler::get() {
     inp = specialchar;
     specialchar = 0;
     readamt = 1;
+  } else if (in_ring) {
+    readamt = in_ring->pop(inp) ? 1 : 0;
   } else {
     // else check if we have input
     readamt = ::read(inputfd, &inp, 1);
@@ -84,12 +116,72 @@ std::optional<char> uart_fd_handler::get() {
 }
 
 void uart_fd_handler::put(char data) {
+  if (out_ring) {
+    // The I/O thread never blocks on the fds, so this only waits for it to
+    // catch up
+    while (!out_ring->push(data))
+      std::this_thread::yield();
+    return;
+  }
   ::write(outputfd, &data, 1);
   if (loggingfd) {
     ::write(loggingfd, &data, 1);
   }
 }
 
+void uart_fd_handler::start_io_thread() {
+  in_ring = std::make_unique<uart_ring_t>(RING_BYTES);
+  out_ring = std::make_unique<uart_ring_t>(RING_BYTES);
+  io_thread = std::thread(&uart_fd_handler::io_loop, this);
+}
+
+// Writes as much of buf as the fd accepts. Like the unbuffered path, output a
+// non-blocking fd cannot take right now (e.g. a PTY nobody is attached to) is
+// dropped.
+static void write_best_effort(int fd, const char *buf, size_t len) {
+  while (len > 0) {
+    ssize_t n = ::write(fd, buf, len);
+    if (n <= 0)
+      return;
+    buf += n;
+    len -= n;
+  }
+}
+
+void uart_fd_handler::io_loop() {
+  std::unique_ptr<char[]> buf(new char[IO_CHUNK_BYTES]);
+  while (true) {
+    bool stopping = io_stop;
+    bool busy = false;
+
+    size_t n = out_ring->peek(buf.get(), IO_CHUNK_BYTES);
+    if (n > 0) {
+      write_best_effort(outputfd, buf.get(), n);
+      if (loggingfd) {
+        ::write(loggingfd, buf.get(), n);
+      }
+      out_ring->consume(n);
+      busy = true;
+    } else if (stopping) {
+      return;
+    }
+
+    size_t space = RING_BYTES - in_ring->size();
+    if (space > 0) {
+      ssize_t r =
+          ::read(inputfd, buf.get(), std::min(space, IO_CHUNK_BYTES));
+      if (r > 0) {
+        in_ring->push(buf.get(), r);
+        busy = true;
+      }
+    }
+
+    if (!busy) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  }
+}
+
 /**
  * UART handler which fetches data from stdin and outputs to stdout.
  */
@@ -159,8 +251,8 @@ public:
   }
 };
 
-static std::unique_ptr<uart_handler>
-create_handler(const std::vector<std::string> &args, int uartno) {
+static std::unique_ptr<uart_fd_handler>
+create_fd_handler(const std::vector<std::string> &args, int uartno) {
   std::string in_arg = std::string("+uart-in") + std::to_string(uartno) + "=";
   std::string out_arg = std::string("+uart-out") + std::to_string(uartno) + "=";
 
@@ -183,28 +275,59 @@ create_handler(const std::vector<std::string> &args, int uartno) {
   return std::make_unique<uart_pty_handler>(uartno);
 }
 
+/**
+ * Creates the handler for a UART. With +uart-socket=<spec>, every UART is
+ * served over a socket (see uart_socket.h). Otherwise, +uart-buffered moves
+ * all fd I/O off the tick path onto a background thread.
+ */
+static std::unique_ptr<uart_handler>
+create_handler(const std::vector<std::string> &args, int uartno) {
+  const std::string socket_arg = "+uart-socket=";
+  bool buffered = false;
+  for (const auto &arg : args) {
+    if (arg.find(socket_arg) == 0) {
+      return create_uart_socket_handler(arg.substr(socket_arg.length()),
+                                        uartno);
+    }
+    if (arg == "+uart-buffered") {
+      buffered = true;
+    }
+  }
+  auto handler = create_fd_handler(args, uartno);
+  if (buffered) {
+    handler->start_io_thread();
+  }
+  return handler;
+}
+
 uart_t::uart_t(simif_t &simif,
                const UARTBRIDGEMODULE_struct &mmio_addrs,
                int uartno,
                const std::vector<std::string> &args)
-    : bridge_driver_t(simif, &KIND), mmio_addrs(mmio_addrs),
+    : io_counted_t<bridge_driver_t>(simif, &KIND), mmio_addrs(mmio_addrs),
       handler(create_handler(args, uartno)) {}
 
 uart_t::~uart_t() = default;
 
+// The handshake writes are only queued here; they go out in the same MMIO
+// batch as the status reads of the following recv()
 void uart_t::send() {
   if (data.in.fire()) {
-    write(mmio_addrs.in_bits, data.in.bits);
-    write(mmio_addrs.in_valid, data.in.valid);
+    batch.write(mmio_addrs.in_bits, data.in.bits);
+    batch.write(mmio_addrs.in_valid, data.in.valid);
   }
   if (data.out.fire()) {
-    write(mmio_addrs.out_ready, data.out.ready);
+    batch.write(mmio_addrs.out_ready, data.out.ready);
   }
 }
 
 void uart_t::recv() {
-  data.in.ready = read(mmio_addrs.in_ready);
-  data.out.valid = read(mmio_addrs.out_valid);
+  const size_t in_ready = batch.read(mmio_addrs.in_ready);
+  const size_t out_valid = batch.read(mmio_addrs.out_valid);
+  submit(batch);
+  data.in.ready = batch.result(in_ready);
+  data.out.valid = batch.result(out_valid);
+  batch.clear();
   if (data.out.valid) {
     data.out.bits = read(mmio_addrs.out_bits);
   }
@@ -213,6 +336,7 @@ void uart_t::recv() {
 void uart_t::tick() {
   data.out.ready = true;
   data.in.valid = false;
+  progress = false;
   do {
     this->recv();
 
@@ -227,7 +351,115 @@ void uart_t::tick() {
       handler->put(data.out.bits);
     }
 
+    progress |= data.in.fire() || data.out.fire();
     this->send();
     data.in.valid = false;
   } while (data.in.fire() || data.out.fire());
+  // The last send() may have queued an input handshake
+  submit(batch);
+  batch.clear();
+}
+
+char uart_stream_t::KIND;
+
+uart_stream_t::uart_stream_t(simif_t &simif,
+                             StreamEngine &stream,
+                             const UARTSTREAMBRIDGEMODULE_struct &mmio_addrs,
+                             int uartno,
+                             const std::vector<std::string> &args,
+                             int stream_to_cpu_idx,
+                             int stream_to_cpu_depth,
+                             int stream_from_cpu_idx,
+                             int stream_from_cpu_depth)
+    : io_counted_t<streaming_bridge_driver_t>(simif, stream, &KIND),
+      mmio_addrs(mmio_addrs),
+      handler(create_handler(args, uartno)),
+      stream_to_cpu_idx(stream_to_cpu_idx),
+      stream_to_cpu_depth(stream_to_cpu_depth),
+      stream_from_cpu_idx(stream_from_cpu_idx),
+      stream_from_cpu_depth(stream_from_cpu_depth) {
+  // Roughly a character time at common baud rates; large enough to batch
+  // bursts of output without making interactive echo feel laggy
+  flush_cycles = 4096;
+  for (const auto &arg : args) {
+    if (arg.find("+uart-stream-flush-cycles=") == 0) {
+      flush_cycles = atoi(arg.c_str() + 26);
+    }
+  }
+}
+
+uart_stream_t::~uart_stream_t() = default;
+
+void uart_stream_t::init() { write(mmio_addrs.flush_cycles, flush_cycles); }
+
+size_t uart_stream_t::recv() {
+  page_aligned_sized_array(OUTBUF, stream_to_cpu_depth * STREAM_WIDTH_BYTES);
+  size_t bytes_received = pull(
+      stream_to_cpu_idx, OUTBUF, stream_to_cpu_depth * STREAM_WIDTH_BYTES, 0);
+  saturated =
+      bytes_received == (size_t)stream_to_cpu_depth * STREAM_WIDTH_BYTES;
+  size_t chars = 0;
+  for (size_t off = 0; off < bytes_received; off += STREAM_WIDTH_BYTES) {
+    const char *beat = OUTBUF + off;
+    size_t count = (uint8_t)beat[0];
+    assert(count <= UART_BEAT_CHARS);
+    for (size_t i = 0; i < count; i++) {
+      handler->put(beat[i + 1]);
+    }
+    chars += count;
+  }
+  return chars;
+}
+
+void uart_stream_t::send() {
+  const size_t max_chars = stream_from_cpu_depth * UART_BEAT_CHARS;
+  while (pending_chars.size() < max_chars) {
+    auto bits = handler->get();
+    if (!bits)
+      break;
+    pending_chars.push_back(*bits);
+  }
+  if (pending_chars.empty())
+    return;
+
+  const size_t num_beats =
+      (pending_chars.size() + UART_BEAT_CHARS - 1) / UART_BEAT_CHARS;
+  page_aligned_sized_array(INBUF, stream_from_cpu_depth * STREAM_WIDTH_BYTES);
+  size_t packed = 0;
+  for (size_t beat = 0; beat < num_beats; beat++) {
+    char *bytes = INBUF + beat * STREAM_WIDTH_BYTES;
+    size_t count = std::min(UART_BEAT_CHARS, pending_chars.size() - packed);
+    memset(bytes, 0, STREAM_WIDTH_BYTES);
+    bytes[0] = count;
+    std::copy_n(pending_chars.begin() + packed, count, bytes + 1);
+    packed += count;
+  }
+
+  // Only drop the characters of beats the stream actually accepted
+  size_t beats_sent =
+      push(stream_from_cpu_idx, INBUF, num_beats * STREAM_WIDTH_BYTES, 0) /
+      STREAM_WIDTH_BYTES;
+  size_t chars_sent = std::min(beats_sent * UART_BEAT_CHARS, packed);
+  progress |= chars_sent > 0;
+  saturated |= beats_sent < num_beats;
+  pending_chars.erase(pending_chars.begin(),
+                      pending_chars.begin() + chars_sent);
+}
+
+void uart_stream_t::tick() {
+  size_t chars_received = recv();
+  progress = chars_received > 0;
+  // A partial DMA batch may hold the last characters the target printed, so
+  // flush the stream every so often while it is quiet
+  if (chars_received == 0 && ++ticks_since_flush >= 1024) {
+    pull_flush(stream_to_cpu_idx);
+    ticks_since_flush = 0;
+  }
+  send();
+}
+
+void uart_stream_t::finish() {
+  pull_flush(stream_to_cpu_idx);
+  while (recv() > 0)
+    ;
 }
@@ -3,10 +3,14 @@
 #ifndef __UART_H
 #define __UART_H
 
+#include "bridges/bridge_activity.h"
+#include "bridges/bridge_io_counters.h"
 #include "bridges/serial_data.h"
 #include "core/bridge_driver.h"
+#include "core/stream_engine.h"
 
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <signal.h>
@@ -28,6 +32,10 @@ struct UARTBRIDGEMODULE_struct {
   uint64_t in_ready;
 };
 
+struct UARTSTREAMBRIDGEMODULE_struct {
+  uint64_t flush_cycles;
+};
+
 /**
  * Base class for callbacks handling data coming in and out a UART stream.
  */
@@ -39,7 +47,8 @@ public:
   virtual void put(char data) = 0;
 };
 
-class uart_t final : public bridge_driver_t {
+class uart_t final : public io_counted_t<bridge_driver_t>,
+                     public bridge_activity_t {
 public:
   /// The identifier for the bridge type used for casts.
   static char KIND;
@@ -56,6 +65,7 @@ public:
 
 private:
   const UARTBRIDGEMODULE_struct mmio_addrs;
+  mmio_batch_t batch;
   std::unique_ptr<uart_handler> handler;
 
   serial_data_t<char> data;
@@ -64,4 +74,58 @@ private:
   void recv();
 };
 
+/**
+ * UART bridge which exchanges characters with the target through the bridge
+ * streams instead of one MMIO access per character.
+ *
+ * Each 512b stream beat holds a character count in its first byte followed by
+ * up to UART_BEAT_CHARS characters, in both directions.
+ */
+class uart_stream_t final : public io_counted_t<streaming_bridge_driver_t>,
+                            public bridge_activity_t {
+public:
+  /// The identifier for the bridge type used for casts.
+  static char KIND;
+
+  static constexpr size_t UART_BEAT_CHARS = STREAM_WIDTH_BYTES - 1;
+
+  uart_stream_t(simif_t &simif,
+                StreamEngine &stream,
+                const UARTSTREAMBRIDGEMODULE_struct &mmio_addrs,
+                int uartno,
+                const std::vector<std::string> &args,
+                int stream_to_cpu_idx,
+                int stream_to_cpu_depth,
+                int stream_from_cpu_idx,
+                int stream_from_cpu_depth);
+
+  ~uart_stream_t() override;
+
+  void init() override;
+  void tick() override;
+  void finish() override;
+
+  bool has_pending_work() const override { return !pending_chars.empty(); }
+
+private:
+  const UARTSTREAMBRIDGEMODULE_struct mmio_addrs;
+  std::unique_ptr<uart_handler> handler;
+
+  const int stream_to_cpu_idx;
+  const int stream_to_cpu_depth;
+  const int stream_from_cpu_idx;
+  const int stream_from_cpu_depth;
+
+  // Host cycles the widget holds a partial beat before sending it
+  uint32_t flush_cycles;
+  // Ticks since the to-host stream was last flushed
+  uint32_t ticks_since_flush = 0;
+  // Input characters that did not fit in the from-host stream yet
+  std::deque<char> pending_chars;
+
+  void send();
+  // Returns the number of characters received
+  size_t recv();
+};
+
 #endif // __UART_H
@@ -0,0 +1,84 @@
+// See LICENSE for license details
+#ifndef __UART_RING_H
+#define __UART_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+/**
+ * Lock-free single-producer/single-consumer byte ring used to hand UART data
+ * between the simulation thread and a UART I/O thread.
+ *
+ * Exactly one thread may push and exactly one thread may pop. The capacity is
+ * rounded up to a power of two; head and tail are free-running counters.
+ */
+class uart_ring_t {
+public:
+  explicit uart_ring_t(size_t min_capacity) {
+    capacity = 1;
+    while (capacity < min_capacity)
+      capacity <<= 1;
+    data.reset(new char[capacity]);
+  }
+
+  size_t size() const {
+    return tail.load(std::memory_order_acquire) -
+           head.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+  bool full() const { return size() == capacity; }
+
+  /// Producer side: appends up to len bytes, returning how many fit.
+  size_t push(const char *src, size_t len) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t h = head.load(std::memory_order_acquire);
+    size_t n = std::min(len, capacity - (t - h));
+    size_t off = t & (capacity - 1);
+    size_t first = std::min(n, capacity - off);
+    memcpy(data.get() + off, src, first);
+    memcpy(data.get(), src + first, n - first);
+    tail.store(t + n, std::memory_order_release);
+    return n;
+  }
+
+  bool push(char c) { return push(&c, 1) == 1; }
+
+  /// Consumer side: removes up to len bytes into dst, returning how many.
+  size_t pop(char *dst, size_t len) {
+    size_t n = peek(dst, len);
+    consume(n);
+    return n;
+  }
+
+  bool pop(char &c) { return pop(&c, 1) == 1; }
+
+  /// Consumer side: copies up to len bytes without removing them.
+  size_t peek(char *dst, size_t len) const {
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t t = tail.load(std::memory_order_acquire);
+    size_t n = std::min(len, t - h);
+    size_t off = h & (capacity - 1);
+    size_t first = std::min(n, capacity - off);
+    memcpy(dst, data.get() + off, first);
+    memcpy(dst + first, data.get(), n - first);
+    return n;
+  }
+
+  /// Consumer side: drops n bytes previously returned by peek.
+  void consume(size_t n) {
+    head.store(head.load(std::memory_order_relaxed) + n,
+               std::memory_order_release);
+  }
+
+private:
+  std::unique_ptr<char[]> data;
+  size_t capacity;
+  // Written only by the consumer / producer respectively
+  alignas(64) std::atomic<size_t> head{0};
+  alignas(64) std::atomic<size_t> tail{0};
+};
+
+#endif // __UART_RING_H
@@ -0,0 +1,373 @@
+// See LICENSE for license details
+
+#include "uart_socket.h"
+#include "bridges/uart_ring.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+class uart_socket_server_t;
+
+class uart_socket_handler final : public uart_handler {
+public:
+  static constexpr size_t RING_BYTES = 1 << 20;
+
+  uart_socket_handler(int uartno,
+                      int listenfd,
+                      const std::string &unix_path,
+                      int loggingfd);
+  ~uart_socket_handler() override;
+
+  std::optional<char> get() override;
+  void put(char data) override;
+
+private:
+  friend class uart_socket_server_t;
+
+  const int uartno;
+  const int listenfd;
+  // Socket file to remove on exit, empty for TCP
+  const std::string unix_path;
+  const int loggingfd;
+  // Currently connected client, owned by the I/O thread
+  int clientfd = -1;
+  // Whether EPOLLIN is dropped on the client because in_ring is full
+  bool input_paused = false;
+
+  uart_ring_t in_ring{RING_BYTES};
+  uart_ring_t out_ring{RING_BYTES};
+
+  std::shared_ptr<uart_socket_server_t> server;
+  uint64_t id;
+};
+
+/**
+ * The I/O thread shared by all socket UARTs. It exists while at least one
+ * handler does.
+ */
+class uart_socket_server_t {
+public:
+  static constexpr size_t IO_CHUNK_BYTES = 1 << 16;
+  // Upper bound on the latency of output produced by the target
+  static constexpr int POLL_TIMEOUT_MS = 1;
+
+  uart_socket_server_t();
+  ~uart_socket_server_t();
+
+  static std::shared_ptr<uart_socket_server_t> instance();
+
+  uint64_t add(uart_socket_handler &handler);
+  void remove(uart_socket_handler &handler);
+
+private:
+  int epfd;
+  std::atomic<bool> stop{false};
+  std::thread io_thread;
+  char buf[IO_CHUNK_BYTES];
+
+  // Guards handlers and everything the I/O thread does with them
+  std::mutex lock;
+  std::unordered_map<uint64_t, uart_socket_handler *> handlers;
+  uint64_t next_id = 0;
+
+  void loop();
+  void accept_client(uart_socket_handler &handler);
+  void close_client(uart_socket_handler &handler);
+  void read_input(uart_socket_handler &handler);
+  // Stops or resumes polling the client for input
+  void pause_input(uart_socket_handler &handler, bool paused);
+  // Returns false if the client could not take all pending output
+  bool drain_output(uart_socket_handler &handler);
+
+  // epoll user data: handler id and whether the event is on the client fd
+  static uint64_t event_key(uint64_t id, bool client) {
+    return (id << 1) | client;
+  }
+};
+
+uart_socket_server_t::uart_socket_server_t() {
+  epfd = epoll_create1(EPOLL_CLOEXEC);
+  if (epfd < 0) {
+    fprintf(stderr, "UART socket: epoll_create1 failed: %s\n", strerror(errno));
+    abort();
+  }
+  io_thread = std::thread(&uart_socket_server_t::loop, this);
+}
+
+uart_socket_server_t::~uart_socket_server_t() {
+  stop = true;
+  io_thread.join();
+  close(epfd);
+}
+
+std::shared_ptr<uart_socket_server_t> uart_socket_server_t::instance() {
+  static std::mutex instance_lock;
+  static std::weak_ptr<uart_socket_server_t> current;
+  std::lock_guard<std::mutex> guard(instance_lock);
+  auto server = current.lock();
+  if (!server) {
+    server = std::make_shared<uart_socket_server_t>();
+    current = server;
+  }
+  return server;
+}
+
+uint64_t uart_socket_server_t::add(uart_socket_handler &handler) {
+  std::lock_guard<std::mutex> guard(lock);
+  uint64_t id = next_id++;
+  handlers[id] = &handler;
+  epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.u64 = event_key(id, false);
+  epoll_ctl(epfd, EPOLL_CTL_ADD, handler.listenfd, &ev);
+  return id;
+}
+
+void uart_socket_server_t::remove(uart_socket_handler &handler) {
+  std::lock_guard<std::mutex> guard(lock);
+  // Hand the last output to the client if it keeps up, and to the log always
+  while (!handler.out_ring.empty() && drain_output(handler))
+    ;
+  if (handler.clientfd >= 0) {
+    close_client(handler);
+  }
+  while (!handler.out_ring.empty()) {
+    drain_output(handler);
+  }
+  epoll_ctl(epfd, EPOLL_CTL_DEL, handler.listenfd, nullptr);
+  handlers.erase(handler.id);
+}
+
+void uart_socket_server_t::accept_client(uart_socket_handler &handler) {
+  int fd = accept4(handler.listenfd, nullptr, nullptr, SOCK_NONBLOCK);
+  if (fd < 0)
+    return;
+  if (handler.clientfd >= 0) {
+    static const char busy[] = "UART already has a client attached\n";
+    send(fd, busy, sizeof(busy) - 1, MSG_NOSIGNAL);
+    close(fd);
+    return;
+  }
+  handler.clientfd = fd;
+  handler.input_paused = false;
+  epoll_event ev = {};
+  ev.events = EPOLLIN | EPOLLRDHUP;
+  ev.data.u64 = event_key(handler.id, true);
+  epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+  printf("UART%d: client attached\n", handler.uartno);
+}
+
+void uart_socket_server_t::close_client(uart_socket_handler &handler) {
+  epoll_ctl(epfd, EPOLL_CTL_DEL, handler.clientfd, nullptr);
+  close(handler.clientfd);
+  handler.clientfd = -1;
+  printf("UART%d: client detached\n", handler.uartno);
+}
+
+void uart_socket_server_t::pause_input(uart_socket_handler &handler,
+                                       bool paused) {
+  // The client fd is level-triggered, so a full ring would otherwise wake
+  // the I/O thread on every pass. Hangups and errors are always reported.
+  epoll_event ev = {};
+  ev.events = paused ? 0 : EPOLLIN | EPOLLRDHUP;
+  ev.data.u64 = event_key(handler.id, true);
+  epoll_ctl(epfd, EPOLL_CTL_MOD, handler.clientfd, &ev);
+  handler.input_paused = paused;
+}
+
+void uart_socket_server_t::read_input(uart_socket_handler &handler) {
+  size_t space = uart_socket_handler::RING_BYTES - handler.in_ring.size();
+  if (space == 0) {
+    pause_input(handler, true);
+    return;
+  }
+  ssize_t n = read(handler.clientfd, buf, std::min(space, IO_CHUNK_BYTES));
+  if (n > 0) {
+    handler.in_ring.push(buf, n);
+  } else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+    close_client(handler);
+  }
+}
+
+bool uart_socket_server_t::drain_output(uart_socket_handler &handler) {
+  size_t n = handler.out_ring.peek(buf, IO_CHUNK_BYTES);
+  if (n == 0)
+    return true;
+  size_t done = n;
+  if (handler.clientfd >= 0) {
+    ssize_t sent = send(handler.clientfd, buf, n, MSG_NOSIGNAL);
+    if (sent >= 0) {
+      done = sent;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      done = 0;
+    } else {
+      close_client(handler);
+    }
+  }
+  if (done > 0 && handler.loggingfd >= 0) {
+    ::write(handler.loggingfd, buf, done);
+  }
+  handler.out_ring.consume(done);
+  return done == n;
+}
+
+void uart_socket_server_t::loop() {
+  epoll_event events[64];
+  while (!stop) {
+    int n = epoll_wait(epfd, events, 64, POLL_TIMEOUT_MS);
+    std::lock_guard<std::mutex> guard(lock);
+    for (int i = 0; i < n; i++) {
+      auto it = handlers.find(events[i].data.u64 >> 1);
+      // The handler may have been removed since epoll_wait returned
+      if (it == handlers.end())
+        continue;
+      uart_socket_handler &handler = *it->second;
+      if (!(events[i].data.u64 & 1)) {
+        accept_client(handler);
+      } else if (handler.clientfd < 0) {
+        continue;
+      } else if (handler.input_paused) {
+        close_client(handler);
+      } else {
+        read_input(handler);
+      }
+    }
+    // Resume input once the target has consumed at least a chunk of it
+    for (auto &[id, handler] : handlers) {
+      if (handler->clientfd >= 0 && handler->input_paused &&
+          uart_socket_handler::RING_BYTES - handler->in_ring.size() >=
+              IO_CHUNK_BYTES) {
+        pause_input(*handler, false);
+      }
+    }
+    // Output is not signalled, so that put() stays syscall-free; instead it is
+    // collected from every UART on each wakeup
+    for (auto &[id, handler] : handlers) {
+      while (!handler->out_ring.empty() && drain_output(*handler))
+        ;
+    }
+  }
+}
+
+uart_socket_handler::uart_socket_handler(int uartno,
+                                         int listenfd,
+                                         const std::string &unix_path,
+                                         int loggingfd)
+    : uartno(uartno), listenfd(listenfd), unix_path(unix_path),
+      loggingfd(loggingfd), server(uart_socket_server_t::instance()) {
+  id = server->add(*this);
+}
+
+uart_socket_handler::~uart_socket_handler() {
+  server->remove(*this);
+  close(listenfd);
+  if (!unix_path.empty()) {
+    unlink(unix_path.c_str());
+  }
+  if (loggingfd >= 0) {
+    close(loggingfd);
+  }
+}
+
+std::optional<char> uart_socket_handler::get() {
+  char c;
+  if (!in_ring.pop(c))
+    return std::nullopt;
+  return c;
+}
+
+void uart_socket_handler::put(char data) {
+  // A connected client that stops reading applies backpressure to the target
+  while (!out_ring.push(data))
+    std::this_thread::yield();
+}
+
+} // namespace
+
+static int listen_unix(const std::string &path) {
+  sockaddr_un addr = {};
+  if (path.size() >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "UART socket path %s is too long\n", path.c_str());
+    abort();
+  }
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path.c_str());
+  unlink(path.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0 || bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(fd, 1) < 0) {
+    fprintf(stderr,
+            "UART socket: could not listen on %s: %s\n",
+            path.c_str(),
+            strerror(errno));
+    abort();
+  }
+  return fd;
+}
+
+static int listen_tcp(int port) {
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  int one = 1;
+  if (fd < 0 ||
+      setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0 ||
+      bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 1) < 0) {
+    fprintf(stderr,
+            "UART socket: could not listen on port %d: %s\n",
+            port,
+            strerror(errno));
+    abort();
+  }
+  return fd;
+}
+
+std::unique_ptr<uart_handler>
+create_uart_socket_handler(const std::string &spec, int uartno) {
+  int listenfd;
+  std::string unix_path;
+  if (spec.find("unix:") == 0) {
+    std::string dir = spec.substr(5);
+    mkdir(dir.c_str(), 0755);
+    unix_path = dir + "/uart" + std::to_string(uartno);
+    listenfd = listen_unix(unix_path);
+    printf("UART%d is on socket %s\n", uartno, unix_path.c_str());
+  } else if (spec.find("tcp:") == 0) {
+    int port = atoi(spec.c_str() + 4) + uartno;
+    listenfd = listen_tcp(port);
+    printf("UART%d is on 127.0.0.1:%d\n", uartno, port);
+  } else {
+    fprintf(stderr,
+            "Invalid +uart-socket=%s, expected unix:<dir> or tcp:<port>\n",
+            spec.c_str());
+    abort();
+  }
+
+  std::string uartlogname = std::string("uartlog") + std::to_string(uartno);
+  printf("UART logfile is being written to %s\n", uartlogname.c_str());
+  int loggingfd = open(uartlogname.c_str(), O_RDWR | O_CREAT, 0644);
+
+  return std::make_unique<uart_socket_handler>(
+      uartno, listenfd, unix_path, loggingfd);
+}
@@ -0,0 +1,27 @@
+// See LICENSE for license details
+#ifndef __UART_SOCKET_H
+#define __UART_SOCKET_H
+
+#include "bridges/uart.h"
+
+#include <memory>
+#include <string>
+
+/**
+ * Creates a handler exposing a UART as a listening socket.
+ *
+ * All socket UARTs in a process are served by a single epoll-driven I/O
+ * thread. Data is exchanged with the bridges through lock-free rings, so the
+ * tick path makes no syscalls regardless of the number of UARTs.
+ *
+ * spec selects the transport:
+ *   unix:<dir>   listen on the Unix-domain socket <dir>/uart<uartno>
+ *   tcp:<port>   listen on 127.0.0.1:<port + uartno>
+ *
+ * One client is served at a time; output produced while no client is
+ * connected is only written to uartlog<uartno>.
+ */
+std::unique_ptr<uart_handler>
+create_uart_socket_handler(const std::string &spec, int uartno);
+
+#endif // __UART_SOCKET_H
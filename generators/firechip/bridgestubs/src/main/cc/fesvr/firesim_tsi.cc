@@ -21,13 +21,19 @@ firesim_tsi_t::firesim_tsi_t(int argc, char **argv, bool can_have_loadmem)
 
 void firesim_tsi_t::idle() {
   is_busy = false;
-  for (size_t i = 0; i < idle_counts; i++)
+  for (size_t i = 0; i < idle_counts; i++) {
+    has_idled = true;
     switch_to_target();
+  }
   is_busy = true;
 }
 
 void firesim_tsi_t::send_loadmem_word(uint32_t word) {
-  loadmem_out_data.push_back(word);
+  loadmem_out_data.push(&word, sizeof(word));
+}
+
+void firesim_tsi_t::send_loadmem_words(const uint32_t *words, size_t count) {
+  loadmem_out_data.push(words, count * sizeof(uint32_t));
 }
 
 void firesim_tsi_t::load_mem_write(addr_t addr,
@@ -40,9 +46,13 @@ void firesim_tsi_t::load_mem_write(addr_t addr,
           nbytes);
   fflush(stdout);
 
+  // fesvr still parses the ELF for its entry point and symbols, but the
+  // segment data is already in target memory
+  if (is_program_preloaded && !is_loaded_in_host)
+    return;
+
   loadmem_write_reqs.push_back(firesim_loadmem_t(addr, nbytes));
-  loadmem_write_data.insert(
-      loadmem_write_data.end(), (const char *)src, (const char *)src + nbytes);
+  loadmem_write_data.push(src, nbytes);
 }
 
 void firesim_tsi_t::load_mem_read(addr_t addr, size_t nbytes, void *dst) {
@@ -57,14 +67,11 @@ void firesim_tsi_t::load_mem_read(addr_t addr, size_t nbytes, void *dst) {
     switch_to_target();
   loadmem_read_reqs.push_back(firesim_loadmem_t(addr, nbytes));
 
-  uint32_t *result = static_cast<uint32_t *>(dst);
-  size_t len = nbytes / sizeof(uint32_t);
-  for (size_t i = 0; i < len; i++) {
-    while (loadmem_out_data.empty())
-      switch_to_target();
-    result[i] = loadmem_out_data.front();
-    loadmem_out_data.pop_front();
-  }
+  // only whole words are returned by the bridge
+  size_t len = nbytes - (nbytes % sizeof(uint32_t));
+  while (loadmem_out_data.size() < len)
+    switch_to_target();
+  loadmem_out_data.pop(dst, len);
 }
 
 void firesim_tsi_t::tick() { switch_to_host(); }
@@ -107,11 +114,7 @@ bool firesim_tsi_t::recv_loadmem_read_req(firesim_loadmem_t &loadmem) {
 }
 
 void firesim_tsi_t::recv_loadmem_data(void *buf, size_t len) {
-  std::copy(loadmem_write_data.begin(),
-            loadmem_write_data.begin() + len,
-            (char *)buf);
-  loadmem_write_data.erase(loadmem_write_data.begin(),
-                           loadmem_write_data.begin() + len);
+  loadmem_write_data.pop(buf, len);
 }
 
 // re-enable fprintfs in file
@@ -2,6 +2,7 @@
 #ifndef __FIRESIM_TSI_H
 #define __FIRESIM_TSI_H
 
+#include "fesvr/loadmem_queue.h"
 #include "testchip_tsi.h"
 
 struct firesim_loadmem_t {
@@ -17,8 +18,20 @@ public:
   ~firesim_tsi_t() {}
 
   bool busy() { return is_busy; };
+  // true if fesvr went idle (found no pending target request) since the
+  // previous call
+  bool take_idled() {
+    bool idled = has_idled;
+    has_idled = false;
+    return idled;
+  };
   bool loaded_in_host() { return is_loaded_in_host; };
   void set_loaded_in_target(bool loaded) { is_loaded_in_target = loaded; };
+  // program memory was already written by the bridge (+loadmem-image), so
+  // drop the memory writes issued while fesvr loads the program
+  void set_program_preloaded(bool preloaded) {
+    is_program_preloaded = preloaded;
+  };
 
   void tick();
   void tick(bool out_valid, uint32_t out_bits, bool in_ready) { tick(); };
@@ -29,6 +42,7 @@ public:
   bool has_loadmem_reqs();
 
   void send_loadmem_word(uint32_t word);
+  void send_loadmem_words(const uint32_t *words, size_t count);
 
   void load_program() override;
 
@@ -47,13 +61,14 @@ protected:
 
   std::deque<firesim_loadmem_t> loadmem_write_reqs;
   std::deque<firesim_loadmem_t> loadmem_read_reqs;
-  std::deque<char> loadmem_write_data;
+  loadmem_queue_t loadmem_write_data;
 
-  std::deque<uint32_t> loadmem_out_data;
+  loadmem_queue_t loadmem_out_data;
 
 private:
   size_t idle_counts;
   bool is_busy;
+  bool has_idled = false;
   // program load has completed in the host thread (i.e. all fesvr xacts for
   // program load have been sent by fesvr)
   bool is_loaded_in_host;
@@ -61,5 +76,7 @@ private:
   // xacts for program load have been synced/drained by the target
   // thread/bridge)
   bool is_loaded_in_target;
+  // program contents were written directly into target memory by the bridge
+  bool is_program_preloaded = false;
 };
 #endif // __FIRESIM_TSI_H
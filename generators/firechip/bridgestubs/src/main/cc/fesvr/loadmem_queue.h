@@ -0,0 +1,88 @@
+// See LICENSE for license details
+#ifndef __LOADMEM_QUEUE_H
+#define __LOADMEM_QUEUE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <memory>
+
+/**
+ * FIFO of raw bytes used to hand loadmem payloads between the fesvr thread and
+ * the bridge thread.
+ *
+ * Data is stored in large contiguous chunks instead of one element per byte,
+ * so moving a multi-MB ELF segment costs a handful of memcpys. Small writes
+ * are coalesced into the tail chunk; writes larger than the chunk size get a
+ * dedicated extent of exactly their size.
+ */
+class loadmem_queue_t {
+public:
+  static constexpr size_t CHUNK_BYTES = 64 * 1024;
+
+  /// Number of bytes currently buffered.
+  size_t size() const { return total; }
+  bool empty() const { return total == 0; }
+
+  /// Appends nbytes from src to the back of the queue.
+  void push(const void *src, size_t nbytes) {
+    const char *in = static_cast<const char *>(src);
+    if (!chunks.empty()) {
+      chunk_t &tail = chunks.back();
+      size_t n = std::min(nbytes, tail.capacity - tail.end);
+      memcpy(tail.data.get() + tail.end, in, n);
+      tail.end += n;
+      in += n;
+      nbytes -= n;
+      total += n;
+    }
+    if (nbytes == 0)
+      return;
+    chunks.emplace_back(std::max(nbytes, CHUNK_BYTES));
+    chunk_t &tail = chunks.back();
+    memcpy(tail.data.get(), in, nbytes);
+    tail.end = nbytes;
+    total += nbytes;
+  }
+
+  /// Removes nbytes from the front of the queue and copies them to dst.
+  /// The caller must ensure at least nbytes are buffered.
+  void pop(void *dst, size_t nbytes) {
+    assert(nbytes <= total);
+    char *out = static_cast<char *>(dst);
+    while (nbytes > 0) {
+      chunk_t &head = chunks.front();
+      size_t n = std::min(nbytes, head.end - head.begin);
+      memcpy(out, head.data.get() + head.begin, n);
+      head.begin += n;
+      out += n;
+      nbytes -= n;
+      total -= n;
+      if (head.begin == head.end)
+        chunks.pop_front();
+    }
+  }
+
+  void clear() {
+    chunks.clear();
+    total = 0;
+  }
+
+private:
+  struct chunk_t {
+    explicit chunk_t(size_t capacity)
+        : data(new char[capacity]), capacity(capacity) {}
+    std::unique_ptr<char[]> data;
+    size_t capacity;
+    // Bytes in [begin, end) are valid and not yet consumed.
+    size_t begin = 0;
+    size_t end = 0;
+  };
+
+  std::deque<chunk_t> chunks;
+  size_t total = 0;
+};
+
+#endif // __LOADMEM_QUEUE_H
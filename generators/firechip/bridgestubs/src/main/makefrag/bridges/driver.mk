@@ -38,7 +38,7 @@ TARGET_CXX_FLAGS += -I$(firechip_lib_dir)/bridge/test
 
 # bridge sources
 # exclude the following types of files for unit testing
-EXCLUDE_LIST := cospike dmibridge groundtest simplenic tsibridge
+EXCLUDE_LIST := cospike dmibridge groundtest simplenic tsi_host tsibridge tsistreambridge
 DRIVER_H += $(shell find $(firechip_lib_dir) -name "*.h")
 DRIVER_CC += \
 		$(filter-out \
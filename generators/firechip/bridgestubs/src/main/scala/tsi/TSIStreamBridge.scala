@@ -0,0 +1,31 @@
+// See LICENSE for license details
+
+package firechip.bridgestubs
+
+import chisel3._
+import chisel3.util._
+
+import org.chipsalliance.cde.config.Parameters
+
+import firesim.lib.bridgeutils._
+
+import firechip.bridgeinterfaces._
+
+class TSIStreamBridge(memoryRegionNameOpt: Option[String]) extends BlackBox with Bridge[HostPortIO[TSIBridgeTargetIO]] {
+  val moduleName = "firechip.goldengateimplementations.TSIStreamBridgeModule"
+  val io = IO(new TSIBridgeTargetIO)
+  val bridgeIO = HostPort(io)
+  val constructorArg = Some(TSIBridgeParams(memoryRegionNameOpt))
+  generateAnnotations()
+}
+
+object TSIStreamBridge {
+  def apply(clock: Clock, port: testchipip.tsi.TSIIO, memoryRegionNameOpt: Option[String], reset: Bool)(implicit p: Parameters): TSIStreamBridge = {
+    val ep = Module(new TSIStreamBridge(memoryRegionNameOpt))
+    require(ep.io.tsi.w == port.w)
+    ep.io.tsi <> port
+    ep.io.clock := clock
+    ep.io.reset := reset
+    ep
+  }
+}
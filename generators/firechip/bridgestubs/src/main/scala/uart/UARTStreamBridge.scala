@@ -0,0 +1,33 @@
+// See LICENSE for license details
+
+package firechip.bridgestubs
+
+import chisel3._
+import chisel3.util._
+
+import org.chipsalliance.cde.config.Parameters
+
+import firesim.lib.bridgeutils._
+
+import firechip.bridgeinterfaces._
+
+class UARTStreamBridge(initBaudRate: BigInt, freqMHz: Int)(implicit p: Parameters) extends BlackBox
+    with Bridge[HostPortIO[UARTBridgeTargetIO]] {
+  val moduleName = "firechip.goldengateimplementations.UARTStreamBridgeModule"
+  val io = IO(new UARTBridgeTargetIO)
+  val bridgeIO = HostPort(io)
+  val div = (BigInt(freqMHz) * 1000000 / initBaudRate).toInt
+  val constructorArg = Some(UARTKey(div))
+  generateAnnotations()
+}
+
+object UARTStreamBridge {
+  def apply(clock: Clock, uart: sifive.blocks.devices.uart.UARTPortIO, reset: Bool, freqMHz: Int)(implicit p: Parameters): UARTStreamBridge = {
+    val ep = Module(new UARTStreamBridge(uart.c.initBaudRate, freqMHz))
+    ep.io.uart.txd := uart.txd
+    uart.rxd := ep.io.uart.rxd
+    ep.io.clock := clock
+    ep.io.reset := reset
+    ep
+  }
+}
@@ -0,0 +1,88 @@
+// See LICENSE for license details
+
+#include "adaptive_step.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+
+adaptive_step_t::adaptive_step_t(const std::vector<std::string> &args) {
+  for (auto &arg : args) {
+    if (arg == "+adaptive-step") {
+      enabled = true;
+    }
+    if (arg.find("+adaptive-step-min=") == 0) {
+      min_step = std::max(1ULL, strtoull(arg.c_str() + 19, nullptr, 10));
+    }
+    if (arg.find("+adaptive-step-grow-after=") == 0) {
+      grow_after = atoi(arg.c_str() + 26);
+    }
+  }
+}
+
+uint64_t adaptive_step_t::next(uint64_t remaining) {
+  last_step = enabled ? std::min(remaining, step_size) : remaining;
+  last_remaining = remaining;
+  if (enabled)
+    step_start = std::chrono::steady_clock::now();
+  return last_step;
+}
+
+void adaptive_step_t::complete(bool progress, bool saturated) {
+  if (!enabled)
+    return;
+
+  int bucket = 0;
+  while (bucket < NUM_BUCKETS - 1 && (1ULL << bucket) < last_step)
+    bucket++;
+  steps[bucket]++;
+  cycles[bucket] += last_step;
+  host_ns[bucket] += std::chrono::duration<double, std::nano>(
+                         std::chrono::steady_clock::now() - step_start)
+                         .count();
+
+  if (saturated) {
+    // Stream-bound: poll the bridges in backoff at shorter cycle intervals
+    idle_steps = 0;
+    step_size = std::max(min_step, std::min(step_size, last_step) / 2);
+  } else if (progress) {
+    idle_steps = 0;
+  } else if (step_size != UNCAPPED && ++idle_steps >= grow_after) {
+    // Back to the default step once the cap no longer splits it
+    step_size = step_size * 2 >= last_remaining ? UNCAPPED : step_size * 2;
+  }
+}
+
+void adaptive_step_t::report(FILE *out) const {
+  if (!enabled)
+    return;
+
+  uint64_t total_steps = 0, total_cycles = 0;
+  double total_ns = 0;
+  for (int i = 0; i < NUM_BUCKETS; i++) {
+    total_steps += steps[i];
+    total_cycles += cycles[i];
+    total_ns += host_ns[i];
+  }
+  if (total_steps == 0)
+    return;
+
+  fprintf(out,
+          "Adaptive step: %" PRIu64 " steps, %" PRIu64
+          " cycles, %.3f MHz overall\n",
+          total_steps,
+          total_cycles,
+          total_ns > 0 ? 1e3 * total_cycles / total_ns : 0.0);
+  for (int i = 0; i < NUM_BUCKETS; i++) {
+    if (steps[i] == 0)
+      continue;
+    fprintf(out,
+            "  step <= %12" PRIu64 ": %10" PRIu64
+            " steps (%5.1f%% of cycles, %5.1f%% of host time, %.3f MHz)\n",
+            (uint64_t)1 << i,
+            steps[i],
+            100.0 * cycles[i] / total_cycles,
+            total_ns > 0 ? 100.0 * host_ns[i] / total_ns : 0.0,
+            host_ns[i] > 0 ? 1e3 * cycles[i] / host_ns[i] : 0.0);
+  }
+}
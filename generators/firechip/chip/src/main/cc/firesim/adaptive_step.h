@@ -0,0 +1,62 @@
+// See LICENSE for license details
+#ifndef __ADAPTIVE_STEP_H
+#define __ADAPTIVE_STEP_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Chooses how many target cycles the simulation loop advances per step.
+ *
+ * By default a step always runs up to the next scheduled task. With
+ * +adaptive-step that remains the baseline, but once a streaming bridge finds
+ * a stream at its full depth, steps are capped by an adaptive size that is
+ * halved on every saturated step, down to +adaptive-step-min=. The cap is
+ * doubled for every step in a run of at least +adaptive-step-grow-after steps
+ * in which no bridge made progress, and lifted once it reaches the step up
+ * to the next task again. Quiet phases thus run with as few step boundaries
+ * as without the flag. Every bridge is polled at each step boundary (see
+ * bridge_scheduler_t::begin_step), so in stream-bound phases the cap bounds,
+ * in target cycles, how long a bridge in idle backoff goes unserviced.
+ *
+ * Target cycles and host time are recorded per log2 step size and reported
+ * at exit as the throughput reached at each size.
+ */
+class adaptive_step_t {
+public:
+  adaptive_step_t(const std::vector<std::string> &args);
+
+  /// Returns the number of cycles to advance next, at most remaining.
+  uint64_t next(uint64_t remaining);
+  /// Accounts for the step returned by the last next().
+  void complete(bool progress, bool saturated);
+
+  void report(FILE *out) const;
+
+private:
+  static constexpr int NUM_BUCKETS = 65;
+
+  static constexpr uint64_t UNCAPPED = UINT64_MAX;
+
+  bool enabled = false;
+  uint64_t min_step = 1024;
+  // Cap on the step, or UNCAPPED to run up to the next task
+  uint64_t step_size = UNCAPPED;
+  uint32_t grow_after = 2;
+  // Length of the current run of idle steps
+  uint32_t idle_steps = 0;
+
+  uint64_t last_step = 0;
+  // Cycles that were left up to the next task when last_step was chosen
+  uint64_t last_remaining = 0;
+  std::chrono::steady_clock::time_point step_start;
+
+  uint64_t steps[NUM_BUCKETS] = {};
+  uint64_t cycles[NUM_BUCKETS] = {};
+  double host_ns[NUM_BUCKETS] = {};
+};
+
+#endif // __ADAPTIVE_STEP_H
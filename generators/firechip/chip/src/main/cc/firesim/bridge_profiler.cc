@@ -0,0 +1,212 @@
+// See LICENSE for license details
+
+#include "bridge_profiler.h"
+#include "bridges/bridge_io_counters.h"
+#include "core/bridge_driver.h"
+
+#include <cinttypes>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <map>
+#include <typeinfo>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+bridge_profiler_t::bridge_profiler_t(const std::vector<std::string> &args) {
+  for (auto &arg : args) {
+    if (arg == "+bridge-profile") {
+      profile_enabled = true;
+    }
+    if (arg.find("+bridge-profile-json=") == 0) {
+      json_path = arg.substr(21);
+    }
+    if (arg.find("+bridge-profile-interval=") == 0) {
+      interval = strtoull(arg.c_str() + 25, nullptr, 10);
+    }
+  }
+  if (!profile_enabled)
+    interval = 0;
+  if (interval && json_path.empty()) {
+    fprintf(stderr, "+bridge-profile-interval requires +bridge-profile-json\n");
+    abort();
+  }
+}
+
+uint64_t bridge_profiler_t::timestamp() {
+#if defined(__x86_64__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+static std::string demangle(const char *name) {
+  int status;
+  char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  std::string result = status == 0 ? demangled : name;
+  free(demangled);
+  return result;
+}
+
+std::vector<std::string>
+bridge_names(const std::vector<bridge_driver_t *> &bridges) {
+  std::vector<std::string> names;
+  std::map<std::string, int> instances;
+  for (auto *bridge : bridges) {
+    std::string type = demangle(typeid(*bridge).name());
+    names.push_back(type + "[" + std::to_string(instances[type]++) + "]");
+  }
+  return names;
+}
+
+void bridge_profiler_t::init(const std::vector<bridge_driver_t *> &bridges) {
+  if (!profile_enabled)
+    return;
+
+  auto names = bridge_names(bridges);
+  for (size_t i = 0; i < bridges.size(); i++) {
+    auto entry = std::make_unique<entry_t>();
+    entry->name = names[i];
+    entry->io = dynamic_cast<bridge_io_counters_t *>(bridges[i]);
+    index[bridges[i]] = entry.get();
+    entries.push_back(std::move(entry));
+  }
+
+  if (interval) {
+    std::string path = json_path + ".snapshots";
+    snapshots = fopen(path.c_str(), "w");
+    if (!snapshots) {
+      fprintf(stderr, "Could not open %s\n", path.c_str());
+      abort();
+    }
+  }
+
+  start_time = std::chrono::steady_clock::now();
+  start_tsc = timestamp();
+}
+
+void bridge_profiler_t::tick(bridge_driver_t *bridge) {
+  if (!profile_enabled) {
+    bridge->tick();
+    return;
+  }
+
+  uint64_t begin = timestamp();
+  bridge->tick();
+  uint64_t elapsed = timestamp() - begin;
+
+  auto &entry = *index.at(bridge);
+  entry.ticks.store(entry.ticks.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+  entry.tsc.store(entry.tsc.load(std::memory_order_relaxed) + elapsed,
+                  std::memory_order_relaxed);
+}
+
+double bridge_profiler_t::tsc_per_ns() const {
+  double ns = std::chrono::duration<double, std::nano>(
+                  std::chrono::steady_clock::now() - start_time)
+                  .count();
+  return ns > 0 ? (timestamp() - start_tsc) / ns : 1.0;
+}
+
+void bridge_profiler_t::write_json(FILE *out,
+                                   double elapsed_ns,
+                                   double scale) const {
+  fprintf(out, "\"elapsed_ns\": %.0f, \"bridges\": [", elapsed_ns);
+  for (size_t i = 0; i < entries.size(); i++) {
+    auto &entry = *entries[i];
+    fprintf(out,
+            "%s{\"name\": \"%s\", \"ticks\": %" PRIu64 ", \"tick_ns\": %.0f",
+            i ? ", " : "",
+            entry.name.c_str(),
+            entry.ticks.load(),
+            entry.tsc.load() / scale);
+    if (entry.io) {
+      fprintf(out,
+              ", \"mmio_reads\": %" PRIu64 ", \"mmio_writes\": %" PRIu64
+              ", \"mmio_batches\": %" PRIu64 ", \"bytes_pulled\": %" PRIu64
+              ", \"bytes_pushed\": %" PRIu64,
+              entry.io->mmio_reads.load(),
+              entry.io->mmio_writes.load(),
+              entry.io->mmio_batches.load(),
+              entry.io->bytes_pulled.load(),
+              entry.io->bytes_pushed.load());
+    }
+    fprintf(out, "}");
+  }
+  fprintf(out, "]");
+}
+
+void bridge_profiler_t::snapshot(uint64_t cycle) {
+  if (!snapshots)
+    return;
+  double scale = tsc_per_ns();
+  double elapsed_ns = (timestamp() - start_tsc) / scale;
+  fprintf(snapshots, "{\"cycle\": %" PRIu64 ", ", cycle);
+  write_json(snapshots, elapsed_ns, scale);
+  fprintf(snapshots, "}\n");
+  fflush(snapshots);
+}
+
+void bridge_profiler_t::report(FILE *out) {
+  if (!profile_enabled)
+    return;
+
+  double scale = tsc_per_ns();
+  double elapsed_ns = (timestamp() - start_tsc) / scale;
+
+  fprintf(out, "Bridge profile (%.3f s of host time):\n", elapsed_ns / 1e9);
+  fprintf(out,
+          "  %-28s %12s %10s %6s %9s %12s %12s %12s %12s\n",
+          "bridge",
+          "ticks",
+          "time (ms)",
+          "%",
+          "ns/tick",
+          "mmio reads",
+          "mmio writes",
+          "pulled (B)",
+          "pushed (B)");
+  for (auto &entry : entries) {
+    uint64_t ticks = entry->ticks.load();
+    double ns = entry->tsc.load() / scale;
+    fprintf(out,
+            "  %-28s %12" PRIu64 " %10.1f %6.2f %9.0f",
+            entry->name.c_str(),
+            ticks,
+            ns / 1e6,
+            elapsed_ns > 0 ? 100.0 * ns / elapsed_ns : 0.0,
+            ticks ? ns / ticks : 0.0);
+    if (entry->io) {
+      fprintf(out,
+              " %12" PRIu64 " %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+              entry->io->mmio_reads.load(),
+              entry->io->mmio_writes.load(),
+              entry->io->bytes_pulled.load(),
+              entry->io->bytes_pushed.load());
+    } else {
+      fprintf(out, " %12s %12s %12s %12s\n", "-", "-", "-", "-");
+    }
+  }
+
+  if (snapshots) {
+    fclose(snapshots);
+    snapshots = nullptr;
+  }
+
+  if (json_path.empty())
+    return;
+  FILE *json = fopen(json_path.c_str(), "w");
+  if (!json) {
+    fprintf(stderr, "Could not open %s\n", json_path.c_str());
+    return;
+  }
+  fprintf(json, "{");
+  write_json(json, elapsed_ns, scale);
+  fprintf(json, "}\n");
+  fclose(json);
+}
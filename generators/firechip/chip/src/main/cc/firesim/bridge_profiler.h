@@ -0,0 +1,81 @@
+// See LICENSE for license details
+#ifndef __BRIDGE_PROFILER_H
+#define __BRIDGE_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class bridge_driver_t;
+class bridge_io_counters_t;
+
+/// Returns a readable name for every bridge: its type and its index among
+/// the bridges of that type, e.g. uart_t[1].
+std::vector<std::string>
+bridge_names(const std::vector<bridge_driver_t *> &bridges);
+
+/**
+ * Measures the host time every bridge spends in tick().
+ *
+ * Enabled with +bridge-profile. Each tick is bracketed with the TSC (or a
+ * steady clock off x86), which is converted to wall time at report time.
+ * Bridges deriving from io_counted_t additionally report their MMIO reads and
+ * writes and the bytes moved over their streams.
+ *
+ * At exit a table is printed and, with +bridge-profile-json=<file>, the same
+ * numbers are written as JSON. +bridge-profile-interval=<cycles> additionally
+ * appends a JSON snapshot line to <file>.snapshots every interval.
+ */
+class bridge_profiler_t {
+public:
+  bridge_profiler_t(const std::vector<std::string> &args);
+
+  bool enabled() const { return profile_enabled; }
+  /// Target cycles between snapshots, or 0 if they are disabled.
+  uint64_t snapshot_interval() const { return interval; }
+
+  /// Registers the bridges to profile. Must be called before any tick.
+  void init(const std::vector<bridge_driver_t *> &bridges);
+
+  /// Ticks the bridge, timing it if profiling is enabled. Safe to call
+  /// concurrently for different bridges.
+  void tick(bridge_driver_t *bridge);
+
+  /// Appends the current counters to the snapshot file.
+  void snapshot(uint64_t cycle);
+  /// Prints the summary table and writes the JSON report.
+  void report(FILE *out);
+
+private:
+  struct entry_t {
+    std::string name;
+    bridge_io_counters_t *io;
+    // Only written by the thread ticking the bridge
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<uint64_t> tsc{0};
+  };
+
+  bool profile_enabled = false;
+  uint64_t interval = 0;
+  std::string json_path;
+  FILE *snapshots = nullptr;
+
+  // Populated by init only, so lookups from worker threads need no lock
+  std::vector<std::unique_ptr<entry_t>> entries;
+  std::unordered_map<bridge_driver_t *, entry_t *> index;
+
+  uint64_t start_tsc = 0;
+  std::chrono::steady_clock::time_point start_time;
+
+  static uint64_t timestamp();
+  // Timestamp units per nanosecond, calibrated since init
+  double tsc_per_ns() const;
+  void write_json(FILE *out, double elapsed_ns, double scale) const;
+};
+
+#endif // __BRIDGE_PROFILER_H
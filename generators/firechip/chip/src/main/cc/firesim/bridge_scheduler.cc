@@ -0,0 +1,110 @@
+// See LICENSE for license details
+
+#include "bridge_scheduler.h"
+#include "bridge_profiler.h"
+#include "bridges/bridge_activity.h"
+#include "core/bridge_driver.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+bridge_scheduler_t::bridge_scheduler_t(const std::vector<std::string> &args,
+                                       bridge_profiler_t &profiler)
+    : profiler(profiler) {
+  for (auto &arg : args) {
+    if (arg == "+bridge-idle-backoff") {
+      backoff_enabled = true;
+    }
+    if (arg.find("+bridge-idle-backoff-max=") == 0) {
+      max_backoff = std::max(1, atoi(arg.c_str() + 25));
+    }
+  }
+}
+
+void bridge_scheduler_t::init(const std::vector<bridge_driver_t *> &bridges) {
+  entries.clear();
+  for (auto *bridge : bridges) {
+    entries.push_back(
+        entry_t{bridge, dynamic_cast<bridge_activity_t *>(bridge)});
+  }
+}
+
+bool bridge_scheduler_t::tick_activity(entry_t &entry) {
+  profiler.tick(entry.bridge);
+  if (entry.activity) {
+    progress |= entry.activity->made_progress();
+    saturated |= entry.activity->stream_saturated();
+  }
+  return entry.bridge->terminate();
+}
+
+bool bridge_scheduler_t::tick_entry(entry_t &entry) {
+  bool terminate = tick_activity(entry);
+  entry.ticked = true;
+  ++ticks_issued;
+
+  if (!entry.activity || entry.activity->made_progress()) {
+    entry.backoff = 0;
+    entry.skip = 0;
+  } else {
+    entry.backoff = std::min(std::max(1u, entry.backoff * 2), max_backoff);
+    uint32_t hint = std::min(entry.activity->poll_hint(), max_backoff);
+    entry.skip = std::max(entry.backoff, hint);
+  }
+  return terminate;
+}
+
+bridge_driver_t *
+bridge_scheduler_t::tick(const std::vector<bridge_driver_t *> &bridges) {
+  if (entries.size() != bridges.size()) {
+    init(bridges);
+  }
+
+  if (!backoff_enabled) {
+    for (auto &entry : entries) {
+      if (tick_activity(entry))
+        return entry.bridge;
+    }
+    ticks_issued += entries.size();
+    return nullptr;
+  }
+
+  for (auto &entry : entries) {
+    entry.ticked = false;
+  }
+
+  // Bridges with buffered work go first, whatever their backoff
+  for (auto &entry : entries) {
+    if (entry.activity && entry.activity->has_pending_work()) {
+      if (tick_entry(entry))
+        return entry.bridge;
+    }
+  }
+
+  for (auto &entry : entries) {
+    if (entry.ticked)
+      continue;
+    if (entry.skip > 0) {
+      --entry.skip;
+      ++ticks_skipped;
+      continue;
+    }
+    if (tick_entry(entry))
+      return entry.bridge;
+  }
+  return nullptr;
+}
+
+void bridge_scheduler_t::report(FILE *out) const {
+  if (!backoff_enabled)
+    return;
+  uint64_t total = ticks_issued + ticks_skipped;
+  fprintf(out,
+          "Bridge scheduler: %" PRIu64 " ticks issued, %" PRIu64
+          " skipped (%.1f%%)\n",
+          ticks_issued,
+          ticks_skipped,
+          total ? 100.0 * ticks_skipped / total : 0.0);
+}
@@ -0,0 +1,83 @@
+// See LICENSE for license details
+#ifndef __BRIDGE_SCHEDULER_H
+#define __BRIDGE_SCHEDULER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class bridge_driver_t;
+class bridge_activity_t;
+class bridge_profiler_t;
+
+/**
+ * Decides which bridges to tick on each pass of the simulation loop.
+ *
+ * By default every bridge is ticked on every pass. With +bridge-idle-backoff,
+ * bridges implementing bridge_activity_t that made no progress are skipped
+ * for an exponentially growing number of passes (up to
+ * +bridge-idle-backoff-max=<passes>), and bridges with pending work are
+ * ticked ahead of the rest. This removes nearly all status MMIO from idle
+ * bridges while keeping busy ones serviced promptly. Backoff never carries
+ * over a step boundary.
+ */
+class bridge_scheduler_t {
+public:
+  bridge_scheduler_t(const std::vector<std::string> &args,
+                     bridge_profiler_t &profiler);
+
+  /// Ticks the bridges due on this pass. Returns the first bridge that asked
+  /// to terminate, or nullptr.
+  bridge_driver_t *tick(const std::vector<bridge_driver_t *> &bridges);
+
+  /// Clears the bridge activity recorded for the previous step and makes
+  /// every bridge due on the next pass, so that no bridge in backoff goes
+  /// unpolled for longer than a step.
+  void begin_step() {
+    progress = false;
+    saturated = false;
+    for (auto &entry : entries)
+      entry.skip = 0;
+  }
+  /// True if a bridge reported progress since begin_step().
+  bool step_progress() const { return progress; }
+  /// True if a bridge reported a saturated stream since begin_step().
+  bool step_saturated() const { return saturated; }
+
+  /// Prints how many bridge ticks were issued and skipped.
+  void report(FILE *out) const;
+
+private:
+  struct entry_t {
+    bridge_driver_t *bridge;
+    // nullptr if the bridge does not report its activity
+    bridge_activity_t *activity;
+    // Passes to skip after the current idle streak
+    uint32_t backoff = 0;
+    // Passes left before the bridge is ticked again
+    uint32_t skip = 0;
+    // Set if the bridge was already ticked during the current pass
+    bool ticked = false;
+  };
+
+  bridge_profiler_t &profiler;
+
+  bool backoff_enabled = false;
+  uint32_t max_backoff = 256;
+  std::vector<entry_t> entries;
+
+  bool progress = false;
+  bool saturated = false;
+
+  uint64_t ticks_issued = 0;
+  uint64_t ticks_skipped = 0;
+
+  void init(const std::vector<bridge_driver_t *> &bridges);
+  // Ticks one bridge and records its activity; returns true on terminate
+  bool tick_activity(entry_t &entry);
+  // As tick_activity, also updating the bridge's backoff
+  bool tick_entry(entry_t &entry);
+};
+
+#endif // __BRIDGE_SCHEDULER_H
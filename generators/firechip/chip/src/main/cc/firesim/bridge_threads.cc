@@ -0,0 +1,74 @@
+// See LICENSE for license details
+
+#include "bridge_threads.h"
+#include "bridges/thread_safe_bridge.h"
+#include "core/bridge_driver.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+
+// Longest a worker waits for work before checking whether to stop
+static constexpr std::chrono::milliseconds IDLE_WAIT(1);
+
+bridge_threads_t::bridge_threads_t(const std::vector<std::string> &args) {
+  for (auto &arg : args) {
+    if (arg == "+bridge-threads") {
+      enabled = true;
+    }
+    if (arg.find("+bridge-thread-cpus=") == 0) {
+      std::istringstream ss(arg.substr(20));
+      std::string cpu;
+      while (std::getline(ss, cpu, ',')) {
+        cpus.push_back(atoi(cpu.c_str()));
+      }
+    }
+  }
+}
+
+bridge_threads_t::~bridge_threads_t() { stop(); }
+
+void bridge_threads_t::start(const std::vector<bridge_driver_t *> &bridges) {
+  if (!enabled)
+    return;
+
+  for (auto *bridge : bridges) {
+    auto *safe = dynamic_cast<thread_safe_bridge_t *>(bridge);
+    if (!safe)
+      continue;
+    safe->offload();
+    int cpu = workers.size() < cpus.size() ? cpus[workers.size()] : -1;
+    workers.emplace_back(&bridge_threads_t::worker, this, safe, cpu);
+  }
+  printf("Processing %zu bridge(s) on dedicated threads\n", workers.size());
+}
+
+void bridge_threads_t::stop() {
+  stopping = true;
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+}
+
+void bridge_threads_t::worker(thread_safe_bridge_t *bridge, int cpu) {
+  if (cpu >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+      fprintf(stderr, "Could not pin bridge thread to CPU %d\n", cpu);
+    }
+  }
+
+  // process() blocks until tick() queues work, so an idle bridge costs no
+  // host CPU
+  while (!stopping) {
+    bridge->process(IDLE_WAIT);
+  }
+  while (bridge->process(std::chrono::microseconds(0)))
+    ;
+}
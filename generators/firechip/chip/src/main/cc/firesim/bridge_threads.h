@@ -0,0 +1,46 @@
+// See LICENSE for license details
+#ifndef __BRIDGE_THREADS_H
+#define __BRIDGE_THREADS_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+class bridge_driver_t;
+class thread_safe_bridge_t;
+
+/**
+ * Moves the host-side processing of thread-safe bridges (see
+ * thread_safe_bridge_t) onto dedicated threads, one per bridge, so that a heavy
+ * stream consumer does not delay the simulation loop.
+ *
+ * Enabled with +bridge-threads. +bridge-thread-cpus=<cpu>,<cpu>,... pins the
+ * threads, in bridge order, to the given host CPUs.
+ *
+ * The bridges are still ticked by the simulation loop, which does all MMIO.
+ * Their workers only process what tick() queued, and block while nothing is
+ * queued.
+ */
+class bridge_threads_t {
+public:
+  bridge_threads_t(const std::vector<std::string> &args);
+  ~bridge_threads_t();
+
+  /// Starts a worker for each thread-safe bridge.
+  void start(const std::vector<bridge_driver_t *> &bridges);
+  /// Waits for the workers to process everything queued so far and stops
+  /// them. Must be called before the bridges are finished.
+  void stop();
+
+private:
+  bool enabled = false;
+  std::vector<int> cpus;
+
+  std::vector<std::thread> workers;
+  std::atomic<bool> stopping{false};
+
+  void worker(thread_safe_bridge_t *bridge, int cpu);
+};
+
+#endif // __BRIDGE_THREADS_H
@@ -0,0 +1,43 @@
+// See LICENSE for license details
+
+#include "fased_metrics.h"
+#include "metrics_exporter.h"
+#include "bridges/fased_memory_timing_model.h"
+#include "core/simif.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+// FASED keeps its register map in FpgaModel::addr_map, which is protected. A
+// pointer to the member formed through a derived class is the accessor; the
+// class is never instantiated.
+struct fpga_model_access_t : public FpgaModel {
+  static const AddressMap &addr_map_of(const FpgaModel &model) {
+    return model.*(&fpga_model_access_t::addr_map);
+  }
+};
+} // namespace
+
+void fased_metrics_add(metrics_exporter_t &metrics,
+                       simif_t &simif,
+                       const FASEDMemoryTimingModel &model,
+                       const std::string &name) {
+  const AddressMap &addr_map = fpga_model_access_t::addr_map_of(model);
+
+  std::vector<std::string> names;
+  std::vector<uint32_t> addrs;
+  for (auto &[reg, addr] : addr_map.r_registers) {
+    if (addr_map.w_reg_exists(reg) || reg.find("Hist") != std::string::npos)
+      continue;
+    names.push_back(name + "." + reg);
+    addrs.push_back(addr);
+  }
+
+  metrics.add_columns(std::move(names),
+                      [&simif, addrs](std::vector<uint64_t> &values) {
+                        for (auto addr : addrs) {
+                          values.push_back(simif.read(addr));
+                        }
+                      });
+}
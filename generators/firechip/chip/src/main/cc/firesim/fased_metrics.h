@@ -0,0 +1,24 @@
+// See LICENSE for license details
+#ifndef __FASED_METRICS_H
+#define __FASED_METRICS_H
+
+#include <string>
+
+class FASEDMemoryTimingModel;
+class metrics_exporter_t;
+class simif_t;
+
+/**
+ * Adds the counters of a FASED memory timing model to the metrics file as
+ * <name>.<register> columns.
+ *
+ * The counters are the ones FASEDMemoryTimingModel::profile() writes to its
+ * own stats file: every register the model can read but not write, except
+ * the latency histogram bins. They are read over MMIO at each sample.
+ */
+void fased_metrics_add(metrics_exporter_t &metrics,
+                       simif_t &simif,
+                       const FASEDMemoryTimingModel &model,
+                       const std::string &name);
+
+#endif // __FASED_METRICS_H
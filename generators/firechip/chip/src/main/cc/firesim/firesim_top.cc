@@ -1,5 +1,11 @@
 // See LICENSE for license details
 
+#include "adaptive_step.h"
+#include "bridge_profiler.h"
+#include "bridge_scheduler.h"
+#include "bridge_threads.h"
+#include "fased_metrics.h"
+#include "metrics_exporter.h"
 #include "bridges/clock.h"
 #include "bridges/fased_memory_timing_model.h"
 #include "bridges/heartbeat.h"
@@ -23,15 +29,33 @@ private:
   simif_t &simif;
   /// Reference to the peek-poke bridge.
   peek_poke_t &peek_poke;
+  /// Times the tick() of every bridge, if enabled.
+  bridge_profiler_t bridge_profiler;
+  /// Picks the bridges to tick on each pass of the simulation loop.
+  bridge_scheduler_t bridge_scheduler;
+  /// Processes thread-safe bridges' data on their own threads, if enabled.
+  bridge_threads_t bridge_threads;
+  /// Splits scheduler steps according to bridge demand, if enabled.
+  adaptive_step_t adaptive_step;
+  /// Periodically records simulation metrics, if enabled.
+  metrics_exporter_t metrics;
   /// Flag to indicate that the simulation was terminated.
   bool terminated = false;
+  /// Exit code of the bridge that terminated the simulation.
+  int exit_code = 0;
+
+  /// Advances the target by cycles, ticking bridges until the step is done.
+  void run_step(const std::vector<bridge_driver_t *> &bridges,
+                uint64_t cycles);
 };
 
 firesim_top_t::firesim_top_t(simif_t &simif,
                              widget_registry_t &registry,
                              const std::vector<std::string> &args)
     : systematic_scheduler_t(args), simulation_t(registry, args), simif(simif),
-      peek_poke(registry.get_widget<peek_poke_t>()) {
+      peek_poke(registry.get_widget<peek_poke_t>()), bridge_profiler(args),
+      bridge_scheduler(args, bridge_profiler),
+      bridge_threads(args), adaptive_step(args), metrics(args) {
 
   // Cycles to advance before profiling instrumentation registers in models.
   std::optional<uint64_t> profile_interval;
@@ -61,24 +85,63 @@ firesim_top_t::firesim_top_t(simif_t &simif,
           return *profile_interval;
         });
   }
+  if (metrics.enabled()) {
+    uint64_t interval = metrics.sample_interval();
+    register_task(0, [this, interval, cycle = uint64_t(0)]() mutable {
+      metrics.sample(cycle);
+      cycle += interval;
+      return interval;
+    });
+  }
+  if (uint64_t interval = bridge_profiler.snapshot_interval()) {
+    register_task(interval, [this, interval, cycle = interval]() mutable {
+      bridge_profiler.snapshot(cycle);
+      cycle += interval;
+      return interval;
+    });
+  }
+}
+
+void firesim_top_t::run_step(const std::vector<bridge_driver_t *> &bridges,
+                             uint64_t cycles) {
+  peek_poke.step(cycles, false);
+  bridge_scheduler.begin_step();
+  while (!peek_poke.is_done() && !terminated) {
+    if (auto *bridge = bridge_scheduler.tick(bridges)) {
+      exit_code = bridge->exit_code();
+      terminated = true;
+    }
+  }
 }
 
 int firesim_top_t::simulation_run() {
-  int exit_code = 0;
+  bridge_profiler.init(registry.get_all_bridges());
+  if (metrics.enabled()) {
+    size_t i = 0;
+    for (auto &mod : registry.get_bridges<FASEDMemoryTimingModel>()) {
+      fased_metrics_add(metrics, simif, *mod, "fased" + std::to_string(i++));
+    }
+  }
+  metrics.init(registry.get_all_bridges());
+  const auto bridges = registry.get_all_bridges();
+  bridge_threads.start(bridges);
   while (!terminated && !finished_scheduled_tasks()) {
     run_scheduled_tasks();
-    peek_poke.step(get_largest_stepsize(), false);
-    while (!peek_poke.is_done() && !terminated) {
-      for (auto *bridge : registry.get_all_bridges()) {
-        bridge->tick();
-        if (bridge->terminate()) {
-          exit_code = bridge->exit_code();
-          terminated = true;
-          break;
-        }
-      }
+    // Without +adaptive-step this is a single step up to the next task
+    uint64_t remaining = get_largest_stepsize();
+    while (remaining > 0 && !terminated) {
+      uint64_t cycles = adaptive_step.next(remaining);
+      run_step(bridges, cycles);
+      adaptive_step.complete(bridge_scheduler.step_progress(),
+                             bridge_scheduler.step_saturated());
+      remaining -= cycles;
     }
   }
+  bridge_threads.stop();
+  bridge_scheduler.report(stdout);
+  bridge_profiler.report(stdout);
+  adaptive_step.report(stdout);
+  metrics.finish();
   return exit_code;
 }
 
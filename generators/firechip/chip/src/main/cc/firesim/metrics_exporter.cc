@@ -0,0 +1,154 @@
+// See LICENSE for license details
+
+#include "metrics_exporter.h"
+#include "bridge_profiler.h"
+#include "bridges/bridge_activity.h"
+#include "bridges/bridge_io_counters.h"
+#include "core/bridge_driver.h"
+
+#include <cinttypes>
+#include <cstdlib>
+
+metrics_exporter_t::metrics_exporter_t(const std::vector<std::string> &args) {
+  for (auto &arg : args) {
+    if (arg.find("+metrics-file=") == 0) {
+      path = arg.substr(14);
+    }
+    if (arg.find("+metrics-interval=") == 0) {
+      interval = strtoull(arg.c_str() + 18, nullptr, 10);
+      if (interval == 0) {
+        fprintf(stderr, "Must provide a metrics interval > 0\n");
+        exit(1);
+      }
+    }
+  }
+}
+
+metrics_exporter_t::~metrics_exporter_t() { finish(); }
+
+void metrics_exporter_t::add_columns(
+    std::vector<std::string> names,
+    std::function<void(std::vector<uint64_t> &)> read) {
+  columns.push_back(columns_t{std::move(names), std::move(read)});
+}
+
+void metrics_exporter_t::init(const std::vector<bridge_driver_t *> &bridges) {
+  if (!enabled())
+    return;
+
+  file = fopen(path.c_str(), "w");
+  if (!file) {
+    fprintf(stderr, "Could not open %s\n", path.c_str());
+    abort();
+  }
+
+  fprintf(file, "cycle\thost_seconds\tcycles_per_second");
+  auto names = bridge_names(bridges);
+  for (size_t i = 0; i < bridges.size(); i++) {
+    source_t source{dynamic_cast<bridge_io_counters_t *>(bridges[i]),
+                    dynamic_cast<bridge_activity_t *>(bridges[i])};
+    if (!source.io && !source.activity)
+      continue;
+    const char *name = names[i].c_str();
+    if (source.io) {
+      fprintf(file,
+              "\t%s.mmio_reads\t%s.mmio_writes\t%s.mmio_batches"
+              "\t%s.bytes_pulled\t%s.bytes_pushed",
+              name,
+              name,
+              name,
+              name,
+              name);
+    }
+    if (source.activity) {
+      fprintf(file, "\t%s.pending", name);
+    }
+    sources.push_back(source);
+  }
+  for (auto &set : columns) {
+    for (auto &name : set.names) {
+      fprintf(file, "\t%s", name.c_str());
+    }
+  }
+  fprintf(file, "\n");
+
+  start_time = std::chrono::steady_clock::now();
+  writer = std::thread(&metrics_exporter_t::write_loop, this);
+}
+
+void metrics_exporter_t::sample(uint64_t cycle) {
+  if (!file)
+    return;
+
+  sample_t sample;
+  sample.cycle = cycle;
+  sample.host_seconds = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - start_time)
+                            .count();
+  for (auto &source : sources) {
+    if (source.io) {
+      sample.values.push_back(source.io->mmio_reads.load());
+      sample.values.push_back(source.io->mmio_writes.load());
+      sample.values.push_back(source.io->mmio_batches.load());
+      sample.values.push_back(source.io->bytes_pulled.load());
+      sample.values.push_back(source.io->bytes_pushed.load());
+    }
+    if (source.activity) {
+      sample.values.push_back(source.activity->has_pending_work());
+    }
+  }
+  for (auto &set : columns) {
+    set.read(sample.values);
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    queue.push_back(std::move(sample));
+  }
+  cv.notify_one();
+}
+
+void metrics_exporter_t::write_loop() {
+  uint64_t last_cycle = 0;
+  double last_seconds = 0;
+  std::unique_lock<std::mutex> guard(lock);
+  while (true) {
+    cv.wait(guard, [&] { return stopping || !queue.empty(); });
+    if (queue.empty())
+      return;
+    std::deque<sample_t> samples;
+    samples.swap(queue);
+    guard.unlock();
+
+    for (auto &sample : samples) {
+      // Rate over the interval since the previous sample
+      double seconds = sample.host_seconds - last_seconds;
+      fprintf(file,
+              "%" PRIu64 "\t%.6f\t%.0f",
+              sample.cycle,
+              sample.host_seconds,
+              seconds > 0 ? (sample.cycle - last_cycle) / seconds : 0.0);
+      for (auto value : sample.values) {
+        fprintf(file, "\t%" PRIu64, value);
+      }
+      fprintf(file, "\n");
+      last_cycle = sample.cycle;
+      last_seconds = sample.host_seconds;
+    }
+    fflush(file);
+    guard.lock();
+  }
+}
+
+void metrics_exporter_t::finish() {
+  if (!file)
+    return;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  cv.notify_one();
+  writer.join();
+  fclose(file);
+  file = nullptr;
+}
@@ -0,0 +1,91 @@
+// See LICENSE for license details
+#ifndef __METRICS_EXPORTER_H
+#define __METRICS_EXPORTER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class bridge_driver_t;
+class bridge_activity_t;
+class bridge_io_counters_t;
+
+/**
+ * Periodically samples simulation metrics into a single columnar file.
+ *
+ * Enabled with +metrics-file=<path>. Every +metrics-interval=<cycles>
+ * (default 10M) the simulation rate and, per bridge, its MMIO and stream
+ * counters (see io_counted_t) and whether it holds pending work (see
+ * bridge_activity_t) are sampled, along with any columns added with
+ * add_columns(), such as the FASED counters. The file is tab-separated, with
+ * one header line naming the columns followed by one line per sample, so it
+ * can be loaded directly by plotting tools and charted against workload
+ * phases.
+ *
+ * Sampling only copies counters; rows are formatted and written by a
+ * background thread so the simulation loop never waits on the file system.
+ */
+class metrics_exporter_t {
+public:
+  metrics_exporter_t(const std::vector<std::string> &args);
+  ~metrics_exporter_t();
+
+  bool enabled() const { return !path.empty(); }
+  /// Target cycles between samples.
+  uint64_t sample_interval() const { return interval; }
+
+  /// Adds columns sampled by calling read, which appends one value per name.
+  /// read runs on the simulation thread while the target is paused. Must be
+  /// called before init().
+  void add_columns(std::vector<std::string> names,
+                   std::function<void(std::vector<uint64_t> &)> read);
+
+  /// Opens the file, writes the header and starts the writer thread.
+  void init(const std::vector<bridge_driver_t *> &bridges);
+  /// Samples every metric at the given target cycle.
+  void sample(uint64_t cycle);
+  /// Writes the outstanding samples and stops the writer thread.
+  void finish();
+
+private:
+  struct source_t {
+    bridge_io_counters_t *io;
+    bridge_activity_t *activity;
+  };
+
+  struct columns_t {
+    std::vector<std::string> names;
+    std::function<void(std::vector<uint64_t> &)> read;
+  };
+
+  struct sample_t {
+    uint64_t cycle;
+    double host_seconds;
+    std::vector<uint64_t> values;
+  };
+
+  std::string path;
+  uint64_t interval = 10000000;
+
+  FILE *file = nullptr;
+  std::vector<source_t> sources;
+  std::vector<columns_t> columns;
+  std::chrono::steady_clock::time_point start_time;
+
+  std::thread writer;
+  std::mutex lock;
+  std::condition_variable cv;
+  std::deque<sample_t> queue;
+  bool stopping = false;
+
+  void write_loop();
+};
+
+#endif // __METRICS_EXPORTER_H
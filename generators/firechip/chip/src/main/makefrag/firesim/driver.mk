@@ -41,7 +41,7 @@ TARGET_LD_FLAGS += \
 		$(LRISCV)
 
 # top-level sources
-DRIVER_CC += $(addprefix $(firechip_lib_dir)/firesim/, $(addsuffix .cc, firesim_top))
+DRIVER_CC += $(addprefix $(firechip_lib_dir)/firesim/, $(addsuffix .cc, firesim_top adaptive_step bridge_profiler bridge_scheduler bridge_threads fased_metrics metrics_exporter))
 TARGET_CXX_FLAGS += -I$(firechip_bridgestubs_lib_dir)/bridge/test
 
 # bridge sources
@@ -76,6 +76,24 @@ class WithTSIBridgeAndHarnessRAMOverSerialTL extends HarnessBinder({
   }
 })
 
+// Same as WithTSIBridgeAndHarnessRAMOverSerialTL, but moves TSI words over the bridge streams instead of MMIO
+class WithTSIStreamBridgeAndHarnessRAMOverSerialTL extends HarnessBinder({
+  case (th: FireSim, port: SerialTLPort, chipId: Int) => {
+    port.io match {
+      case io: DecoupledExternalSyncPhitIO => {
+        io.clock_in := th.harnessBinderClock
+        val ram = Module(LazyModule(new SerialRAM(port.serdesser, port.params)(port.serdesser.p)).module)
+        ram.io.ser.in <> io.out
+        io.in <> ram.io.ser.out
+
+        val hasMainMemory = th.chipParameters(chipId)(ExtMem).isDefined
+        val mainMemoryName = Option.when(hasMainMemory)(MainMemoryConsts.globalName(chipId))
+        TSIStreamBridge(th.harnessBinderClock, ram.io.tsi.get, mainMemoryName, th.harnessBinderReset.asBool)(th.p)
+      }
+    }
+  }
+})
+
 class WithDMIBridge extends HarnessBinder({
   case (th: FireSim, port: DMIPort, chipId: Int) => {
     // This assumes that:
@@ -101,6 +119,13 @@ class WithUARTBridge extends HarnessBinder({
     UARTBridge(uartSyncClock, port.io, th.harnessBinderReset.asBool, port.freqMHz)(th.p)
 })
 
+// Same as WithUARTBridge, but moves characters over the bridge streams instead of MMIO
+class WithUARTStreamBridge extends HarnessBinder({
+  case (th: FireSim, port: UARTPort, chipId: Int) =>
+    val uartSyncClock = th.harnessClockInstantiator.requestClockMHz("uart_clock", port.freqMHz)
+    UARTStreamBridge(uartSyncClock, port.io, th.harnessBinderReset.asBool, port.freqMHz)(th.p)
+})
+
 class WithBlockDeviceBridge extends HarnessBinder({
   case (th: FireSim, port: BlockDevicePort, chipId: Int) => {
     BlockDevBridge(port.io.clock, port.io.bits, th.harnessBinderReset.asBool)
@@ -223,6 +223,14 @@ extends BridgeModule[HostPortIO[BlockDevBridgeTargetIO]]()(p) {
     genROReg(~wAckStallN, "bdev_wack_stalled")
     genROReg(~rRespStallN, "bdev_rresp_stalled")
 
+    // Queue occupancy, so the driver can move several entries per MMIO batch.
+    // The target only fills the queues to the CPU and only drains the ones
+    // from it, so a value read once remains a safe bound.
+    genROReg(reqBuf.io.count, "bdev_req_count")
+    genROReg(dataBuf.io.count, "bdev_data_count")
+    genROReg(rRespBuf.entries.U - rRespBuf.io.count, "bdev_rresp_space")
+    genROReg(wAckBuf.entries.U - wAckBuf.io.count, "bdev_wack_space")
+
     genCRFile()
 
     override def genHeader(base: BigInt, memoryRegions: Map[String, BigInt], sb: StringBuilder): Unit = {
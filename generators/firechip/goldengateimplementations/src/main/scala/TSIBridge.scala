@@ -56,6 +56,11 @@ class TSIBridgeModule(tsiBridgeParams: TSIBridgeParams)(implicit p: Parameters)
     genROReg(tokensToEnqueue === 0.U, "done")
     Pulsify(genWORegInit(start, "start", false.B), pulseLength = 1)
 
+    // Queue occupancy, so the driver can move several words per MMIO batch.
+    // The driver only runs once done is set, while the target is paused.
+    genROReg(outBuf.io.count, "out_count")
+    genROReg(inBuf.entries.U - inBuf.io.count, "in_space")
+
     genCRFile()
 
     override def genHeader(base: BigInt, memoryRegions: Map[String, BigInt], sb: StringBuilder): Unit = {
@@ -0,0 +1,134 @@
+// See LICENSE for license details
+
+package firechip.goldengateimplementations
+
+import chisel3._
+import chisel3.util._
+
+import org.chipsalliance.cde.config.Parameters
+
+import midas.widgets._
+import firesim.lib.bridgeutils._
+
+import firechip.bridgeinterfaces._
+
+/** TSI bridge which moves TSI words through the bridge streams instead of one MMIO access per word. MMIO is only used
+  * for step control.
+  *
+  * Each stream beat carries a word count in its low TSI.WIDTH bits, followed by up to beatWords TSI words.
+  */
+class TSIStreamBridgeModule(tsiBridgeParams: TSIBridgeParams)(implicit p: Parameters)
+    extends BridgeModule[HostPortIO[TSIBridgeTargetIO]]()(p)
+    with StreamToHostCPU
+    with StreamFromHostCPU {
+  // Stream mixin parameters
+  val toHostCPUQueueDepth = 256
+  val fromHostCPUQueueDepth = 256
+
+  lazy val module = new BridgeModuleImp(this) {
+    val io = IO(new WidgetIO)
+    val hPort = IO(HostPort(new TSIBridgeTargetIO))
+
+    val beatWords = BridgeStreamConstants.streamWidthBits / TSI.WIDTH - 1
+
+    val inBuf  = Module(new Queue(UInt(TSI.WIDTH.W), 16))
+    val outBuf = Module(new Queue(UInt(TSI.WIDTH.W), 16))
+    val tokensToEnqueue = RegInit(0.U(32.W))
+
+    val target = hPort.hBits.tsi
+    val tFire = hPort.toHost.hValid && hPort.fromHost.hReady && tokensToEnqueue =/= 0.U
+    val targetReset = tFire & hPort.hBits.reset
+    inBuf.reset  := reset.asBool || targetReset
+    outBuf.reset := reset.asBool || targetReset
+
+    hPort.toHost.hReady := tFire
+    hPort.fromHost.hValid := tFire
+
+    target.in <> inBuf.io.deq
+    inBuf.io.deq.ready := target.in.ready && tFire
+
+    outBuf.io.enq <> target.out
+    outBuf.io.enq.valid := target.out.valid && tFire
+
+    val stepDone = tokensToEnqueue === 0.U
+
+    // Target -> host: pack words into a beat. A partial beat is sent once the
+    // step is over, since no more words can arrive until the host restarts it.
+    val outWords = Reg(Vec(beatWords, UInt(TSI.WIDTH.W)))
+    val outCount = RegInit(0.U(log2Ceil(beatWords + 1).W))
+    val outFull = outCount === beatWords.U
+    val outFlush = outCount =/= 0.U && (outFull || (stepDone && !outBuf.io.deq.valid))
+
+    outBuf.io.deq.ready := !outFlush && !outFull
+    when (outBuf.io.deq.fire) {
+      outWords(outCount) := outBuf.io.deq.bits
+      outCount := outCount + 1.U
+    }
+
+    streamEnq.valid := outFlush
+    streamEnq.bits := Cat(outWords.asUInt, outCount.pad(TSI.WIDTH))
+    when (streamEnq.fire || targetReset) {
+      outCount := 0.U
+    }
+
+    // Host -> target: unpack one beat at a time into the input buffer
+    val inBeat = Reg(UInt(BridgeStreamConstants.streamWidthBits.W))
+    val inCount = RegInit(0.U(log2Ceil(beatWords + 1).W))
+    val inIdx = RegInit(0.U(log2Ceil(beatWords + 1).W))
+    val inWords = inBeat(BridgeStreamConstants.streamWidthBits - 1, TSI.WIDTH).asTypeOf(Vec(beatWords, UInt(TSI.WIDTH.W)))
+
+    streamDeq.ready := inIdx === inCount
+    when (streamDeq.fire) {
+      inBeat := streamDeq.bits
+      inCount := streamDeq.bits(inCount.getWidth - 1, 0)
+      inIdx := 0.U
+    }
+
+    inBuf.io.enq.valid := inIdx =/= inCount
+    inBuf.io.enq.bits := inWords(inIdx)
+    when (inBuf.io.enq.fire) {
+      inIdx := inIdx + 1.U
+    }
+    when (targetReset) {
+      inCount := 0.U
+      inIdx := 0.U
+    }
+
+    val stepSize = Wire(UInt(32.W))
+    val start = Wire(Bool())
+    when (start) {
+      tokensToEnqueue := stepSize
+    }.elsewhen (tFire) {
+      tokensToEnqueue := tokensToEnqueue - 1.U
+    }
+
+    genWOReg(stepSize, "step_size")
+    // Only report done once every word produced during the step is in the stream
+    genROReg(stepDone && !outBuf.io.deq.valid && outCount === 0.U, "done")
+    Pulsify(genWORegInit(start, "start", false.B), pulseLength = 1)
+
+    genCRFile()
+
+    override def genHeader(base: BigInt, memoryRegions: Map[String, BigInt], sb: StringBuilder): Unit = {
+      val memoryRegionNameOpt = tsiBridgeParams.memoryRegionNameOpt
+      val offsetConst = memoryRegionNameOpt.map(memoryRegions(_)).getOrElse(BigInt(0))
+
+      genConstructor(
+          base,
+          sb,
+          "tsistreambridge_t",
+          "tsistreambridge",
+          Seq(
+              CppBoolean(tsiBridgeParams.memoryRegionNameOpt.isDefined),
+              UInt64(offsetConst),
+              UInt32(toHostStreamIdx),
+              UInt32(toHostCPUQueueDepth),
+              UInt32(fromHostStreamIdx),
+              UInt32(fromHostCPUQueueDepth),
+          ),
+          hasLoadMem = true,
+          hasStreams = true
+      )
+    }
+  }
+}
@@ -54,6 +54,43 @@ class UARTBridgeModule(key: UARTKey)(implicit p: Parameters) extends BridgeModul
     hPort.toHost.hReady := fire
     hPort.fromHost.hValid := fire
     // DOC include end: UART Bridge Header
+    // Model the target's serial line, moving characters to and from the FIFOs
+    UARTSerdes(div, fire, target, txfifo.io.enq, rxfifo.io.deq)
+
+    // DOC include start: UART Bridge Footer
+    // Exposed the head of the queue and the valid bit as a read-only registers
+    // with name "out_bits" and out_valid respectively
+    genROReg(txfifo.io.deq.bits, "out_bits")
+    genROReg(txfifo.io.deq.valid, "out_valid")
+
+    // Generate a writeable register, "out_ready", that when written to dequeues
+    // a single element in the tx_fifo. Pulsify derives the register back to false
+    // after pulseLength cycles to prevent multiple dequeues
+    Pulsify(genWORegInit(txfifo.io.deq.ready, "out_ready", false.B), pulseLength = 1)
+
+    // Generate regisers for the rx-side of the UART; this is eseentially the reverse of the above
+    genWOReg(rxfifo.io.enq.bits, "in_bits")
+    Pulsify(genWORegInit(rxfifo.io.enq.valid, "in_valid", false.B), pulseLength = 1)
+    genROReg(rxfifo.io.enq.ready, "in_ready")
+
+    // This method invocation is required to wire up all of the MMIO registers to
+    // the simulation control bus (AXI4-lite)
+    genCRFile()
+    // DOC include end: UART Bridge Footer
+
+    override def genHeader(base: BigInt, memoryRegions: Map[String, BigInt], sb: StringBuilder): Unit = {
+      genConstructor(base, sb, "uart_t", "uart")
+    }
+  }
+}
+
+/** Serializer/deserializer modeling the target's serial line, shared by the UART bridges.
+  *
+  * Characters sent by the target are enqueued into tx and characters dequeued from rx are driven onto the target's
+  * rxd. Both directions only advance on host cycles where fire is asserted.
+  */
+object UARTSerdes {
+  def apply(div: Int, fire: Bool, target: UARTPortIO, tx: DecoupledIO[UInt], rx: DecoupledIO[UInt]): Unit = {
     val sTxIdle :: sTxWait :: sTxData :: sTxBreak :: Nil = Enum(4)
     val txState = RegInit(sTxIdle)
     val txData = Reg(UInt(8.W))
@@ -92,8 +129,8 @@ class UARTBridgeModule(key: UARTKey)(implicit p: Parameters) extends BridgeModul
       }
     }
 
-    txfifo.io.enq.bits  := txData
-    txfifo.io.enq.valid := txDataWrap
+    tx.bits  := txData
+    tx.valid := txDataWrap
 
     val sRxIdle :: sRxStart :: sRxData :: Nil = Enum(3)
     val rxState = RegInit(sRxIdle)
@@ -106,7 +143,7 @@ class UARTBridgeModule(key: UARTKey)(implicit p: Parameters) extends BridgeModul
     switch(rxState) {
       is(sRxIdle) {
         target.rxd := 1.U
-        when (rxBaudWrap && rxfifo.io.deq.valid) {
+        when (rxBaudWrap && rx.valid) {
           rxState := sRxStart
         }
       }
@@ -117,37 +154,12 @@ class UARTBridgeModule(key: UARTKey)(implicit p: Parameters) extends BridgeModul
         }
       }
       is(sRxData) {
-        target.rxd := (rxfifo.io.deq.bits >> rxDataIdx)(0)
+        target.rxd := (rx.bits >> rxDataIdx)(0)
         when(rxDataWrap && rxBaudWrap) {
           rxState := sRxIdle
         }
       }
     }
-    rxfifo.io.deq.ready := (rxState === sRxData) && rxDataWrap && rxBaudWrap && fire
-
-    // DOC include start: UART Bridge Footer
-    // Exposed the head of the queue and the valid bit as a read-only registers
-    // with name "out_bits" and out_valid respectively
-    genROReg(txfifo.io.deq.bits, "out_bits")
-    genROReg(txfifo.io.deq.valid, "out_valid")
-
-    // Generate a writeable register, "out_ready", that when written to dequeues
-    // a single element in the tx_fifo. Pulsify derives the register back to false
-    // after pulseLength cycles to prevent multiple dequeues
-    Pulsify(genWORegInit(txfifo.io.deq.ready, "out_ready", false.B), pulseLength = 1)
-
-    // Generate regisers for the rx-side of the UART; this is eseentially the reverse of the above
-    genWOReg(rxfifo.io.enq.bits, "in_bits")
-    Pulsify(genWORegInit(rxfifo.io.enq.valid, "in_valid", false.B), pulseLength = 1)
-    genROReg(rxfifo.io.enq.ready, "in_ready")
-
-    // This method invocation is required to wire up all of the MMIO registers to
-    // the simulation control bus (AXI4-lite)
-    genCRFile()
-    // DOC include end: UART Bridge Footer
-
-    override def genHeader(base: BigInt, memoryRegions: Map[String, BigInt], sb: StringBuilder): Unit = {
-      genConstructor(base, sb, "uart_t", "uart")
-    }
+    rx.ready := (rxState === sRxData) && rxDataWrap && rxBaudWrap && fire
   }
 }
@@ -0,0 +1,117 @@
+// See LICENSE for license details
+
+package firechip.goldengateimplementations
+
+import chisel3._
+import chisel3.util._
+
+import org.chipsalliance.cde.config.Parameters
+
+import midas.widgets._
+import firesim.lib.bridgeutils._
+
+import firechip.bridgeinterfaces._
+
+/** UART bridge which moves characters through the bridge streams instead of one MMIO access per character.
+  *
+  * Each stream beat carries a character count in its low byte, followed by up to beatChars characters. A partially
+  * filled beat headed to the host is sent once no character arrived for flush_cycles host cycles, so interactive
+  * output is not held back waiting for a full beat.
+  */
+class UARTStreamBridgeModule(key: UARTKey)(implicit p: Parameters)
+    extends BridgeModule[HostPortIO[UARTBridgeTargetIO]]()(p)
+    with StreamToHostCPU
+    with StreamFromHostCPU {
+  // Stream mixin parameters
+  val toHostCPUQueueDepth = 256
+  val fromHostCPUQueueDepth = 256
+
+  lazy val module = new BridgeModuleImp(this) {
+    val div = key.div
+    val io = IO(new WidgetIO())
+    val hPort = IO(HostPort(new UARTBridgeTargetIO))
+
+    val beatChars = BridgeStreamConstants.streamWidthBits / 8 - 1
+
+    val txfifo = Module(new Queue(UInt(8.W), 128))
+    val rxfifo = Module(new Queue(UInt(8.W), 128))
+
+    val target = hPort.hBits.uart
+    val fire = hPort.toHost.hValid && hPort.fromHost.hReady && txfifo.io.enq.ready
+    val targetReset = fire & hPort.hBits.reset
+    rxfifo.reset := reset.asBool || targetReset
+    txfifo.reset := reset.asBool || targetReset
+
+    hPort.toHost.hReady := fire
+    hPort.fromHost.hValid := fire
+
+    UARTSerdes(div, fire, target, txfifo.io.enq, rxfifo.io.deq)
+
+    // Target -> host: pack characters into a beat
+    val flushCycles = Wire(UInt(32.W))
+    val outChars = Reg(Vec(beatChars, UInt(8.W)))
+    val outCount = RegInit(0.U(log2Ceil(beatChars + 1).W))
+    val outIdle = RegInit(0.U(32.W))
+    val outFull = outCount === beatChars.U
+    val outFlush = outCount =/= 0.U && (outFull || outIdle >= flushCycles)
+
+    txfifo.io.deq.ready := !outFlush && !outFull
+    when (txfifo.io.deq.fire) {
+      outChars(outCount) := txfifo.io.deq.bits
+      outCount := outCount + 1.U
+      outIdle := 0.U
+    }.elsewhen (outCount =/= 0.U && !outFlush) {
+      outIdle := outIdle + 1.U
+    }
+
+    streamEnq.valid := outFlush
+    streamEnq.bits := Cat(outChars.asUInt, outCount.pad(8))
+    when (streamEnq.fire || targetReset) {
+      outCount := 0.U
+      outIdle := 0.U
+    }
+
+    // Host -> target: unpack one beat at a time into the rx FIFO
+    val inBeat = Reg(UInt(BridgeStreamConstants.streamWidthBits.W))
+    val inCount = RegInit(0.U(log2Ceil(beatChars + 1).W))
+    val inIdx = RegInit(0.U(log2Ceil(beatChars + 1).W))
+    val inChars = inBeat(BridgeStreamConstants.streamWidthBits - 1, 8).asTypeOf(Vec(beatChars, UInt(8.W)))
+
+    streamDeq.ready := inIdx === inCount
+    when (streamDeq.fire) {
+      inBeat := streamDeq.bits
+      inCount := streamDeq.bits(inCount.getWidth - 1, 0)
+      inIdx := 0.U
+    }
+
+    rxfifo.io.enq.valid := inIdx =/= inCount
+    rxfifo.io.enq.bits := inChars(inIdx)
+    when (rxfifo.io.enq.fire) {
+      inIdx := inIdx + 1.U
+    }
+    when (targetReset) {
+      inCount := 0.U
+      inIdx := 0.U
+    }
+
+    genWOReg(flushCycles, "flush_cycles")
+
+    genCRFile()
+
+    override def genHeader(base: BigInt, memoryRegions: Map[String, BigInt], sb: StringBuilder): Unit = {
+      genConstructor(
+          base,
+          sb,
+          "uart_stream_t",
+          "uart_stream",
+          Seq(
+              UInt32(toHostStreamIdx),
+              UInt32(toHostCPUQueueDepth),
+              UInt32(fromHostStreamIdx),
+              UInt32(fromHostCPUQueueDepth),
+          ),
+          hasStreams = true
+      )
+    }
+  }
+}
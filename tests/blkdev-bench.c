@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <riscv-pk/encoding.h>
+#include "mmio.h"
+#include "blkdev.h"
+
+/*
+ * Block device throughput with up to BLKDEV_NREQUEST requests in flight.
+ *
+ * Sweeps request length, write ratio and the number of requests kept in
+ * flight, and reports sectors per kilocycle for each. Rerun with
+ * +blkdev-rlatency0/+blkdev-wlatency0 to see the effect of the modelled
+ * device latency.
+ */
+
+#define SECTOR_WORDS (BLKDEV_SECTOR_SIZE / sizeof(uint64_t))
+#define MAX_INFLIGHT 16
+#define MAX_REQ_SECTORS 16
+#define TEST_SECTORS 2048
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+static uint64_t bufs[MAX_INFLIGHT][MAX_REQ_SECTORS * SECTOR_WORDS]
+	__attribute__ ((aligned (64)));
+static int free_bufs[MAX_INFLIGHT];
+static int tag_buf[256];
+
+static const unsigned int lens[] = {1, 2, 4, 8, 16};
+static const unsigned int write_pcts[] = {0, 50, 100};
+
+static unsigned long run(
+		unsigned int len,
+		unsigned int write_pct,
+		unsigned int depth,
+		unsigned int nsectors)
+{
+	unsigned int nreqs = TEST_SECTORS / len;
+	unsigned int issued = 0, completed = 0, inflight = 0, writes = 0;
+	unsigned int offset = 0, nfree = depth;
+	unsigned long start, end;
+	int tag, buf, ncomplete;
+	unsigned char write;
+
+	for (unsigned int i = 0; i < depth; i++)
+		free_bufs[i] = i;
+
+	start = rdcycle();
+
+	while (completed < nreqs) {
+		while (issued < nreqs && inflight < depth &&
+				reg_read8(BLKDEV_NREQUEST) > 0) {
+			/* Spread the writes evenly over the requests */
+			write = (issued + 1) * write_pct / 100 > writes;
+			writes += write;
+			if (offset + len > nsectors)
+				offset = 0;
+
+			buf = free_bufs[--nfree];
+			tag = blkdev_send_request(
+					(unsigned long) bufs[buf], offset, len, write);
+			tag_buf[tag] = buf;
+
+			offset += len;
+			issued++;
+			inflight++;
+		}
+
+		ncomplete = reg_read8(BLKDEV_NCOMPLETE);
+		for (int i = 0; i < ncomplete; i++) {
+			tag = reg_read8(BLKDEV_COMPLETE);
+			free_bufs[nfree++] = tag_buf[tag];
+			inflight--;
+			completed++;
+		}
+	}
+
+	end = rdcycle();
+
+	return end - start;
+}
+
+int main(void)
+{
+	unsigned int nsectors = blkdev_nsectors();
+	unsigned int max_req_len = blkdev_max_req_len();
+	unsigned int ntags = reg_read8(BLKDEV_NREQUEST);
+	unsigned int depths[2];
+	unsigned long cycles, rate;
+
+	if (nsectors < MAX_REQ_SECTORS) {
+		printf("Error: blkdev nsectors not large enough: %u < %u\n",
+				nsectors, MAX_REQ_SECTORS);
+		return 1;
+	}
+
+	if (ntags > MAX_INFLIGHT)
+		ntags = MAX_INFLIGHT;
+	depths[0] = 1;
+	depths[1] = ntags;
+
+	printf("blkdev: %u sectors, %u max request length, %u tags\n",
+			nsectors, max_req_len, ntags);
+	printf("%8s %8s %8s %12s %16s\n",
+			"len", "write%", "inflight", "cycles", "sectors/kcycle");
+
+	for (size_t l = 0; l < ARRAY_SIZE(lens); l++) {
+		if (lens[l] > max_req_len || lens[l] > MAX_REQ_SECTORS)
+			break;
+		for (size_t w = 0; w < ARRAY_SIZE(write_pcts); w++) {
+			for (int d = 0; d < 2; d++) {
+				if (d > 0 && depths[d] == depths[d - 1])
+					continue;
+				cycles = run(lens[l], write_pcts[w], depths[d], nsectors);
+				/* In hundredths; no float printf here */
+				rate = TEST_SECTORS * 100000UL / cycles;
+				printf("%8u %8u %8u %12lu %13lu.%02lu\n",
+						lens[l], write_pcts[w], depths[d], cycles,
+						rate / 100, rate % 100);
+			}
+		}
+	}
+
+	return 0;
+}
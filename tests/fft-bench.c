@@ -0,0 +1,65 @@
+/* This Test should be used with the fft generator config -- FFTRocketConfig. */
+
+/*
+ * Measures MMIO-bound frame throughput: the FFT block has no queue counts
+ * or DMA, so every sample is one blocking register access, as in fft.c.
+ * The result is the cost of the core feeding the block, not of the block.
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <riscv-pk/encoding.h>
+#include "mmio.h"
+#include "stream-bench.h"
+
+#define FFT_WRITE_LANE  0x2400
+#define FFT_RD_LANE_BASE 0x2408
+// addr of read lane i is FFT_RD_LANE_BASE + i * 8
+#define FFT_POINTS 8
+
+// Thousands of samples rather than one frame
+#define FRAMES 512
+
+// Same frame and results as fft.c
+const uint32_t points[FFT_POINTS] = {
+  0x00B5FF4B, 0x0000FF00, 0xFF4BFF4B, 0xFF000000,
+  0xFF4B00B5, 0x00000100, 0x00B500B5, 0x01000000,
+};
+
+const uint32_t expected_outputs[FFT_POINTS] = {
+  0x00000000, 0x00000000, 0x00000000, 0xffff0000,
+  0x00000000, 0x00000000, 0x00000000, 0x05a8fa57,
+};
+
+static uint32_t out[FRAMES][FFT_POINTS];
+
+int main(void) {
+  unsigned long start, cycles, samples = FRAMES * FFT_POINTS;
+
+  // The FFT has no queue counts; a lane read waits for its result, so
+  // frames go in and come out back to back
+  start = rdcycle();
+  for (int f = 0; f < FRAMES; f++) {
+    for (int i = 0; i < FFT_POINTS; i++)
+      reg_write32(FFT_WRITE_LANE, points[i]);
+    for (int i = 0; i < FFT_POINTS; i++)
+      out[f][i] = reg_read32(FFT_RD_LANE_BASE + i * 8);
+  }
+  cycles = rdcycle() - start;
+
+  stream_header();
+  stream_report("fft", samples, cycles);
+
+  for (int f = 0; f < FRAMES; f++) {
+    for (int i = 0; i < FFT_POINTS; i++) {
+      if (out[f][i] != expected_outputs[i]) {
+        printf("FAIL: frame %d lane %d: %x expected %x\n",
+               f, i, out[f][i], expected_outputs[i]);
+        return -1;
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,263 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <riscv-pk/encoding.h>
+#include "sync.h"
+
+/*
+ * Memory hierarchy characterization.
+ *
+ *   stream      STREAM copy/scale/add/triad on hart 0, best of NTRIALS
+ *   chase       dependent loads through a random cyclic permutation of
+ *               cache lines, from 4 KiB up to CHASE_MAX_BYTES
+ *   contention  triad on 1..n harts at once, each on its own slice
+ *
+ * Every hart that checks in through sync.h takes part in the contention
+ * test, so the same binary runs on any number of cores. Results are printed
+ * as CSV rows whose first column names the test, after a '#' line naming
+ * the columns, e.g. `grep ^chase, uart.log`. Rates are in bytes per
+ * kilocycle; there is no float printf here.
+ */
+
+#ifndef STREAM_ELEMS
+#define STREAM_ELEMS (1 << 18)
+#endif
+#ifndef CHASE_MAX_BYTES
+#define CHASE_MAX_BYTES (16 << 20)
+#endif
+#define CHASE_MIN_BYTES (4 << 10)
+#define CHASE_LOADS (1 << 16)
+#define LINE_BYTES 64
+#define NTRIALS 3
+
+static double a[STREAM_ELEMS], b[STREAM_ELEMS], c[STREAM_ELEMS];
+
+static struct sync_central_barrier barrier;
+static struct sync_counter hart_cycles;
+
+/* Rate in bytes per kilocycle */
+static unsigned long rate(unsigned long bytes, unsigned long cycles)
+{
+	return cycles ? bytes * 1000 / cycles : 0;
+}
+
+/*
+ * STREAM
+ */
+
+enum { COPY, SCALE, ADD, TRIAD, NKERNELS };
+
+static const char *kernel_names[NKERNELS] = {"copy", "scale", "add", "triad"};
+static const int kernel_arrays[NKERNELS] = {2, 2, 3, 3};
+
+static void run_kernel(int kernel, size_t lo, size_t hi)
+{
+	const double scalar = 3.0;
+
+	switch (kernel) {
+	case COPY:
+		for (size_t i = lo; i < hi; i++)
+			c[i] = a[i];
+		break;
+	case SCALE:
+		for (size_t i = lo; i < hi; i++)
+			b[i] = scalar * c[i];
+		break;
+	case ADD:
+		for (size_t i = lo; i < hi; i++)
+			c[i] = a[i] + b[i];
+		break;
+	case TRIAD:
+		for (size_t i = lo; i < hi; i++)
+			a[i] = b[i] + scalar * c[i];
+		break;
+	}
+}
+
+static int stream(void)
+{
+	unsigned long best[NKERNELS], start, cycles;
+	double ea = 1.0, eb = 2.0, ec = 0.0;
+
+	for (size_t i = 0; i < STREAM_ELEMS; i++) {
+		a[i] = 1.0;
+		b[i] = 2.0;
+		c[i] = 0.0;
+	}
+
+	for (int k = 0; k < NKERNELS; k++)
+		best[k] = -1UL;
+
+	for (int t = 0; t < NTRIALS; t++) {
+		for (int k = 0; k < NKERNELS; k++) {
+			start = rdcycle();
+			run_kernel(k, 0, STREAM_ELEMS);
+			cycles = rdcycle() - start;
+			if (cycles < best[k])
+				best[k] = cycles;
+		}
+		ec = ea;
+		eb = 3.0 * ec;
+		ec = ea + eb;
+		ea = eb + 3.0 * ec;
+	}
+
+	/* Small integers throughout, so the results are exact */
+	for (size_t i = 0; i < STREAM_ELEMS; i++) {
+		if (a[i] != ea || b[i] != eb || c[i] != ec) {
+			printf("Error: stream mismatch at %lu\n", i);
+			return 1;
+		}
+	}
+
+	printf("# stream,kernel,bytes,cycles,bytes_per_kcycle\n");
+	for (int k = 0; k < NKERNELS; k++) {
+		unsigned long bytes =
+			kernel_arrays[k] * sizeof(double) * STREAM_ELEMS;
+		printf("stream,%s,%lu,%lu,%lu\n", kernel_names[k],
+				bytes, best[k], rate(bytes, best[k]));
+	}
+	return 0;
+}
+
+/*
+ * Pointer chase
+ */
+
+static uint64_t xorshift(uint64_t *state)
+{
+	uint64_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	return *state = x;
+}
+
+/*
+ * Links the first n lines of buf into a single random cycle (Sattolo's
+ * algorithm), so every load misses the prefetchers and the whole footprint
+ * is visited.
+ */
+static void **link_lines(char *buf, uint32_t *order, size_t n,
+		uint64_t *seed)
+{
+	for (size_t i = 0; i < n; i++)
+		order[i] = i;
+	for (size_t i = n - 1; i > 0; i--) {
+		size_t j = xorshift(seed) % i;
+		uint32_t tmp = order[i];
+
+		order[i] = order[j];
+		order[j] = tmp;
+	}
+	for (size_t i = 0; i < n; i++)
+		*(void **) (buf + (size_t) order[i] * LINE_BYTES) =
+			buf + (size_t) order[(i + 1) % n] * LINE_BYTES;
+
+	return (void **) (buf + (size_t) order[0] * LINE_BYTES);
+}
+
+static int chase(void)
+{
+	size_t max_lines = CHASE_MAX_BYTES / LINE_BYTES;
+	char *buf = malloc(CHASE_MAX_BYTES + LINE_BYTES);
+	uint32_t *order = malloc(max_lines * sizeof(*order));
+	uint64_t seed = 0x2545f4914f6cdd1dUL;
+	unsigned long start, cycles;
+	void **p;
+
+	if (!buf || !order) {
+		printf("Error: could not allocate %d byte chase buffer\n",
+				CHASE_MAX_BYTES);
+		return 1;
+	}
+	buf = (char *) (((uintptr_t) buf + LINE_BYTES - 1) &
+			~(uintptr_t) (LINE_BYTES - 1));
+
+	printf("# chase,bytes,loads,cycles,cycles_per_load_x100\n");
+	for (size_t bytes = CHASE_MIN_BYTES; bytes <= CHASE_MAX_BYTES;
+			bytes *= 2) {
+		p = link_lines(buf, order, bytes / LINE_BYTES, &seed);
+
+		/* One lap to warm up, then time */
+		for (size_t i = 0; i < bytes / LINE_BYTES; i++)
+			p = *p;
+		start = rdcycle();
+		for (int i = 0; i < CHASE_LOADS; i++)
+			p = *p;
+		cycles = rdcycle() - start;
+		/* Keep the chain live */
+		asm volatile ("" :: "r" (p));
+
+		printf("chase,%lu,%d,%lu,%lu\n", bytes, CHASE_LOADS, cycles,
+				cycles * 100 / CHASE_LOADS);
+	}
+
+	return 0;
+}
+
+/*
+ * Contention
+ */
+
+static void contend(int id)
+{
+	size_t slice = STREAM_ELEMS / sync_nharts;
+	unsigned long start;
+
+	for (int n = 1; n <= sync_nharts; n++) {
+		sync_central_wait(&barrier, id);
+		if (id < n) {
+			start = rdcycle();
+			run_kernel(TRIAD, id * slice, (id + 1) * slice);
+			hart_cycles.slot[id].v = rdcycle() - start;
+		}
+		sync_central_wait(&barrier, id);
+		if (id == 0) {
+			unsigned long bytes = 3 * sizeof(double) * slice * n;
+			unsigned long lo = -1UL, hi = 0;
+
+			for (int h = 0; h < n; h++) {
+				unsigned long cyc = hart_cycles.slot[h].v;
+
+				if (cyc < lo)
+					lo = cyc;
+				if (cyc > hi)
+					hi = cyc;
+			}
+			printf("contention,%d,%lu,%lu,%lu,%lu\n", n, bytes,
+					lo, hi, rate(bytes, hi));
+		}
+	}
+}
+
+void __main(void)
+{
+	int id = sync_join();
+
+	sync_wait(id);
+	contend(id);
+	while (1);
+}
+
+int main(void)
+{
+	int nharts = sync_discover(SYNC_CHECKIN_CYCLES);
+
+	sync_central_init(&barrier, nharts);
+	printf("# mem-bench: %d harts, %d stream elements\n",
+			nharts, STREAM_ELEMS);
+
+	/* The other harts stay parked in sync_wait() until the contention test */
+	if (stream() || chase())
+		return 1;
+
+	printf("# contention,harts,bytes,min_cycles,max_cycles,"
+			"bytes_per_kcycle\n");
+	sync_release();
+	contend(0);
+
+	return 0;
+}
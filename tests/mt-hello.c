@@ -1,48 +1,35 @@
 #include <riscv-pk/encoding.h>
 #include <stdio.h>
 #include "marchid.h"
+#include "sync.h"
 
-// EDIT THIS
-static size_t n_cores = 4;
+static struct sync_central_barrier barrier;
 
-static void __attribute__((noinline)) barrier()
+static void hello(int id)
 {
-  static volatile int sense;
-  static volatile int count;
-  static __thread int threadsense;
-
-  __sync_synchronize();
-
-  threadsense = !threadsense;
-  if (__sync_fetch_and_add(&count, 1) == n_cores-1)
-  {
-    count = 0;
-    sense = threadsense;
+  const char* march = get_march(read_csr(marchid));
+  for (int i = 0; i < sync_nharts; i++) {
+    if (id == i) {
+      printf("Hello world from core %lu, a %s\n", read_csr(mhartid), march);
+    }
+    sync_central_wait(&barrier, id);
   }
-  else while(sense != threadsense)
-    ;
-
-  __sync_synchronize();
 }
 
 void __main(void) {
-  size_t mhartid = read_csr(mhartid);
+  int id = sync_join();
 
-  if (mhartid >= n_cores) while (1);
-
-  const char* march = get_march(read_csr(marchid));
-  for (size_t i = 0; i < n_cores; i++) {
-    if (mhartid == i) {
-      printf("Hello world from core %lu, a %s\n", mhartid, march);
-    }
-    barrier();
-  }
+  sync_wait(id);
+  hello(id);
 
   // Spin if not core 0
-  if (mhartid > 0) while (1);
+  while (1);
 }
 
 int main(void) {
-  __main();
+  // The core count is however many harts check in
+  sync_central_init(&barrier, sync_discover(SYNC_CHECKIN_CYCLES));
+  sync_release();
+  hello(0);
   return 0;
 }
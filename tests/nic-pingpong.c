@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <riscv-pk/encoding.h>
+#include "mmio.h"
+#include "nic.h"
+
+/*
+ * NIC round-trip latency.
+ *
+ * Every node sends NPINGS pings, one at a time, stamped with rdcycle() when
+ * they are posted, and echoes the pings of its peer, so the same binary runs
+ * on both nodes of a two-node network. Under +nic-loopback a node gets its
+ * own pings back, which count as the round trip directly.
+ *
+ * The round trip can be no faster than the links it crosses: one
+ * +linklatency in loopback, four (two each way, through the switch) between
+ * nodes. LINK_LATENCY should match the +linklatency of the run.
+ */
+
+#ifndef TARGET_MHZ
+#define TARGET_MHZ 3200
+#endif
+#ifndef LINK_LATENCY
+#define LINK_LATENCY 6405
+#endif
+
+#define NPINGS 256
+#define PING_BYTES 64
+#define NET_IP_ALIGN 2
+#define MAC_ADDR_SIZE 6
+/* IEEE 802 local experimental ethertype */
+#define BENCH_ETHTYPE 0x88b5
+#define PING 1
+#define PONG 2
+
+struct bench_packet {
+	uint8_t padding[NET_IP_ALIGN];
+	uint8_t dst_mac[MAC_ADDR_SIZE];
+	uint8_t src_mac[MAC_ADDR_SIZE];
+	uint16_t ethtype;
+	uint32_t type;
+	uint32_t seq;
+	uint64_t timestamp;
+};
+
+static inline uint16_t htons(uint16_t nint)
+{
+	return ((nint & 0xff) << 8) | ((nint >> 8) & 0xff);
+}
+
+static uint64_t ping_buf[PING_BYTES / 8];
+static uint64_t pong_buf[PING_BYTES / 8];
+static uint64_t recv_buf[PING_BYTES / 8];
+static unsigned long rtts[NPINGS];
+
+static void send_packet(uint64_t *buf, int type, uint32_t seq,
+		uint64_t timestamp)
+{
+	struct bench_packet *pkt = (struct bench_packet *) buf;
+
+	pkt->type = type;
+	pkt->seq = seq;
+	pkt->timestamp = timestamp;
+	asm volatile ("fence");
+	nic_send(buf, PING_BYTES);
+}
+
+static void sort(unsigned long *values, int n)
+{
+	for (int i = 1; i < n; i++) {
+		unsigned long v = values[i];
+		int j = i;
+
+		for (; j > 0 && values[j - 1] > v; j--)
+			values[j] = values[j - 1];
+		values[j] = v;
+	}
+}
+
+/* Cycles to nanoseconds at TARGET_MHZ */
+static unsigned long ns(unsigned long cycles)
+{
+	return cycles * 1000 / TARGET_MHZ;
+}
+
+int main(void)
+{
+	uint64_t macaddr = nic_macaddr();
+	struct bench_packet *ping = (struct bench_packet *) ping_buf;
+	struct bench_packet *pong = (struct bench_packet *) pong_buf;
+	struct bench_packet *in = (struct bench_packet *) recv_buf;
+	static const int pcts[] = {0, 50, 90, 99};
+	int nrtts = 0, nechoed = 0, loopback = 0, waiting = 0;
+	unsigned long floor, p50;
+
+	memset(ping, 0xff, sizeof(ping_buf));
+	memcpy(ping->src_mac, &macaddr, MAC_ADDR_SIZE);
+	ping->ethtype = htons(BENCH_ETHTYPE);
+	memcpy(pong, ping, sizeof(ping_buf));
+
+	printf("nic-pingpong: %d pings of %d bytes, %d MHz, linklatency %d\n",
+			NPINGS, PING_BYTES, TARGET_MHZ, LINK_LATENCY);
+
+	/*
+	 * A node in a pair is done once its peer has stopped pinging too,
+	 * otherwise the peer waits forever on its last pong.
+	 */
+	while (nrtts < NPINGS || (!loopback && nechoed < NPINGS)) {
+		if (!waiting && nrtts < NPINGS) {
+			send_packet(ping_buf, PING, nrtts, rdcycle());
+			waiting = 1;
+		}
+
+		nic_recv(recv_buf);
+		if (htons(in->ethtype) != BENCH_ETHTYPE)
+			continue;
+
+		if (in->type == PING &&
+				memcmp(in->src_mac, &macaddr, MAC_ADDR_SIZE)) {
+			memcpy(pong->dst_mac, in->src_mac, MAC_ADDR_SIZE);
+			send_packet(pong_buf, PONG, in->seq, in->timestamp);
+			nechoed++;
+			continue;
+		}
+
+		/* Our own ping came straight back */
+		if (in->type == PING)
+			loopback = 1;
+		if (in->seq != (uint32_t) nrtts) {
+			printf("Error: got seq %u, expected %d\n",
+					in->seq, nrtts);
+			return 1;
+		}
+		rtts[nrtts++] = rdcycle() - in->timestamp;
+		waiting = 0;
+	}
+
+	sort(rtts, NPINGS);
+	floor = (loopback ? 1 : 4) * LINK_LATENCY;
+	printf("%s, link latency floor %lu cycles (%lu ns)\n",
+			loopback ? "loopback" : "two-node", floor, ns(floor));
+	printf("%6s %12s %10s\n", "pct", "cycles", "ns");
+	for (size_t i = 0; i < sizeof(pcts) / sizeof(pcts[0]); i++) {
+		unsigned long rtt = rtts[pcts[i] * NPINGS / 100];
+		printf("%5d%% %12lu %10lu\n", pcts[i], rtt, ns(rtt));
+	}
+	printf("%6s %12lu %10lu\n", "max", rtts[NPINGS - 1],
+			ns(rtts[NPINGS - 1]));
+
+	p50 = rtts[NPINGS / 2];
+	printf("median overhead over the links: %lu cycles\n",
+			p50 > floor ? p50 - floor : 0);
+	if (rtts[0] < floor) {
+		printf("Error: %lu cycle round trip is below the link latency; "
+				"rebuild with a matching LINK_LATENCY\n", rtts[0]);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <riscv-pk/encoding.h>
+#include "mmio.h"
+#include "nic.h"
+
+/*
+ * NIC streaming throughput.
+ *
+ * Keeps the send request queue full and collects completions in batches, so
+ * the rate is bounded by the NIC and the +netbw rate limiter rather than a
+ * round trip per packet. Receives are kept posted as well, so the same binary
+ * works under +nic-loopback and on two nodes behind a switch (packets go to
+ * the broadcast address). Runs a stream of MTU-sized packets, then sweeps
+ * the packet size.
+ *
+ * Rates are converted to Gbit/s at TARGET_MHZ and compared against NETBW,
+ * which should match the +netbw the simulation was started with.
+ */
+
+#ifndef TARGET_MHZ
+#define TARGET_MHZ 3200
+#endif
+#ifndef NETBW
+#define NETBW 200
+#endif
+/* +netbw is a fraction of this, one 64-bit flit per cycle */
+#define MAX_NETBW 200
+/* Link rate at TARGET_MHZ scaled by +netbw, in Mbit/s */
+#define CEILING_MBPS (64UL * TARGET_MHZ * NETBW / MAX_NETBW)
+
+#define ETH_MAX_BYTES 1520
+#define NPACKETS 1024
+#define NRECV_BUFS 32
+/* Cycles without a receive completion before giving up on the rest */
+#define DRAIN_TIMEOUT 1000000
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+static uint8_t send_buf[ETH_MAX_BYTES] __attribute__ ((aligned (64)));
+static uint8_t recv_bufs[NRECV_BUFS][ETH_MAX_BYTES]
+	__attribute__ ((aligned (64)));
+/* Receives stay posted from one run to the next */
+static unsigned long recv_posted, recv_done;
+
+static const unsigned int sizes[] = {64, 128, 256, 512, 1024, ETH_MAX_BYTES};
+
+struct run_stats {
+	unsigned long send_cycles;
+	unsigned long recv_cycles;
+	unsigned long recv_packets;
+	unsigned long recv_bytes;
+};
+
+static void post_recvs(unsigned int avail)
+{
+	while (avail > 0 && recv_posted - recv_done < NRECV_BUFS) {
+		nic_post_recv(recv_bufs[recv_posted % NRECV_BUFS]);
+		recv_posted++;
+		avail--;
+	}
+}
+
+static unsigned int collect_recvs(unsigned int ncomps, struct run_stats *stats)
+{
+	for (unsigned int i = 0; i < ncomps; i++)
+		stats->recv_bytes += reg_read16(SIMPLENIC_RECV_COMP);
+	asm volatile ("fence");
+	recv_done += ncomps;
+	stats->recv_packets += ncomps;
+	return ncomps;
+}
+
+static void run(unsigned int size, struct run_stats *stats)
+{
+	unsigned int sent = 0, send_done = 0;
+	unsigned long start, now, last_recv;
+	uint32_t counts;
+
+	memset(stats, 0, sizeof(*stats));
+	start = rdcycle();
+	last_recv = start;
+
+	while (send_done < NPACKETS) {
+		/* One read of the counts drives all four queues */
+		counts = reg_read32(SIMPLENIC_COUNTS);
+
+		for (unsigned int n = counts & 0xff; n > 0 && sent < NPACKETS; n--) {
+			nic_post_send(send_buf, size);
+			sent++;
+		}
+		post_recvs((counts >> 8) & 0xff);
+
+		for (unsigned int n = (counts >> 16) & 0xff; n > 0; n--) {
+			reg_read16(SIMPLENIC_SEND_COMP);
+			send_done++;
+		}
+		if (collect_recvs(counts >> 24, stats))
+			last_recv = rdcycle();
+	}
+	stats->send_cycles = rdcycle() - start;
+
+	/* Let the packets still on the link land */
+	now = rdcycle();
+	while (stats->recv_packets < NPACKETS &&
+			now - last_recv < DRAIN_TIMEOUT) {
+		counts = reg_read32(SIMPLENIC_COUNTS);
+		post_recvs((counts >> 8) & 0xff);
+		now = rdcycle();
+		if (collect_recvs(counts >> 24, stats))
+			last_recv = now;
+	}
+	stats->recv_cycles = last_recv - start;
+}
+
+/* Megabits per second at TARGET_MHZ */
+static unsigned long mbps(unsigned long bytes, unsigned long cycles)
+{
+	return cycles ? bytes * 8 * TARGET_MHZ / cycles : 0;
+}
+
+static void print_run(unsigned int size, const struct run_stats *stats)
+{
+	unsigned long tx = mbps((unsigned long) size * NPACKETS,
+			stats->send_cycles);
+	unsigned long rx = mbps(stats->recv_bytes, stats->recv_cycles);
+
+	printf("%8u %12lu %7lu.%03lu %12lu %7lu.%03lu %8lu %6lu%%\n",
+			size, stats->send_cycles, tx / 1000, tx % 1000,
+			stats->recv_cycles, rx / 1000, rx % 1000,
+			stats->recv_packets, tx * 100 / CEILING_MBPS);
+}
+
+int main(void)
+{
+	uint64_t macaddr = nic_macaddr();
+	unsigned long ceiling = CEILING_MBPS;
+	struct run_stats stats;
+	unsigned long tx;
+
+	/* Broadcast destination, our own source address */
+	memset(send_buf, 0, sizeof(send_buf));
+	memset(send_buf + 2, 0xff, 6);
+	memcpy(send_buf + 8, &macaddr, 6);
+	asm volatile ("fence");
+
+	printf("nic-pktgen: %d packets per run, %d MHz, netbw %d "
+			"(ceiling %lu.%03lu Gbit/s)\n", NPACKETS, TARGET_MHZ,
+			NETBW, ceiling / 1000, ceiling % 1000);
+	printf("%8s %12s %11s %12s %11s %8s %7s\n", "bytes", "tx cycles",
+			"tx Gbit/s", "rx cycles", "rx Gbit/s", "rx pkts",
+			"ceiling");
+
+	/* Stream at the MTU first, then sweep the size */
+	run(ETH_MAX_BYTES, &stats);
+	print_run(ETH_MAX_BYTES, &stats);
+	tx = mbps((unsigned long) ETH_MAX_BYTES * NPACKETS, stats.send_cycles);
+	printf("\n");
+
+	for (size_t i = 0; i < ARRAY_SIZE(sizes); i++) {
+		run(sizes[i], &stats);
+		print_run(sizes[i], &stats);
+	}
+
+	/*
+	 * The rate limiter cannot be beaten, so a faster stream means the
+	 * simulation was run with a different +netbw or clock than compiled in.
+	 */
+	if (tx > ceiling + ceiling / 20) {
+		printf("Error: %lu Mbit/s exceeds +netbw=%d at %d MHz; "
+				"rebuild with matching NETBW/TARGET_MHZ\n",
+				tx, NETBW, TARGET_MHZ);
+		return 1;
+	}
+
+	return 0;
+}
@@ -26,13 +26,27 @@ static inline int nic_recv_comp_avail(void)
 	return (reg_read32(SIMPLENIC_COUNTS) >> 24) & 0xff;
 }
 
-static void nic_send(void *data, unsigned long len)
+/*
+ * Non-blocking halves of nic_send/nic_recv. The caller checks the queue has
+ * room (SIMPLENIC_COUNTS holds all four counts, so one read covers both
+ * directions) and collects the completions itself.
+ */
+static inline void nic_post_send(void *data, unsigned long len)
 {
 	uintptr_t addr = ((uintptr_t) data) & ((1L << 48) - 1);
-	unsigned long packet = (len << 48) | addr;
 
+	reg_write64(SIMPLENIC_SEND_REQ, (len << 48) | addr);
+}
+
+static inline void nic_post_recv(void *dest)
+{
+	reg_write64(SIMPLENIC_RECV_REQ, (uintptr_t) dest);
+}
+
+static void nic_send(void *data, unsigned long len)
+{
 	while (nic_send_req_avail() == 0);
-	reg_write64(SIMPLENIC_SEND_REQ, packet);
+	nic_post_send(data, len);
 
 	while (nic_send_comp_avail() == 0);
 	reg_read16(SIMPLENIC_SEND_COMP);
@@ -40,11 +54,10 @@ static void nic_send(void *data, unsigned long len)
 
 static int nic_recv(void *dest)
 {
-	uintptr_t addr = (uintptr_t) dest;
 	int len;
 
 	while (nic_recv_req_avail() == 0);
-	reg_write64(SIMPLENIC_RECV_REQ, addr);
+	nic_post_recv(dest);
 
 	// Poll for completion
 	while (nic_recv_comp_avail() == 0);
@@ -0,0 +1,215 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "nvdla.h"
+#include "mmio.h"
+#include <riscv-pk/encoding.h>
+
+#define NVDLA_BASE 0x10040000
+#define reg_write(addr,val) reg_write32(NVDLA_BASE+addr,val)
+#define reg_read(addr) reg_read32(NVDLA_BASE+addr)
+
+/*
+ * NVDLA layer timing.
+ *
+ * Layers are tables of register writes played back in order rather than
+ * straight-line code, so several can share one program: each descriptor is
+ * the CDP layer of nvdla.c with its own overrides of the cube size. Every
+ * layer is programmed into the register group the consumer points at, run
+ * REPEATS times, and timed from op enable to its done interrupt. Results
+ * are CSV rows:
+ *
+ *   nvdla,<layer>,<run>,<bytes>,<config_cycles>,<run_cycles>,<bytes_per_kcycle>
+ *
+ * where bytes counts the cube read plus the cube written. Compare across
+ * configs to see how sensitive the layer is to the memory system.
+ */
+
+#define REPEATS 2
+#define POLL_LIMIT (1 << 20)
+
+/* Writes value, value + 1, ... count times */
+struct nvdla_write {
+    uint32_t addr;
+    uint32_t value;
+    uint32_t count;
+};
+
+#define W(addr, value) {addr, value, 1}
+#define FILL(addr, first, count) {addr, first, count}
+
+struct nvdla_layer {
+    const char *name;
+    const struct nvdla_write *writes;
+    unsigned int nwrites;
+    uint32_t bytes;
+};
+
+#define LAYER(name, writes, bytes) \
+    {name, writes, sizeof(writes) / sizeof(writes[0]), bytes}
+
+// The LUTs are single registers, shared by every layer
+static const struct nvdla_write cdp_lut[] = {
+    W(CDP_S_LUT_ACCESS_CFG_0, 0x30000),
+    FILL(CDP_S_LUT_ACCESS_DATA_0, 0x0, 0x101),
+    W(CDP_S_LUT_ACCESS_CFG_0, 0x20000),
+    FILL(CDP_S_LUT_ACCESS_DATA_0, 0x0, 0x41),
+    W(CDP_S_LUT_LE_START_LOW_0, 0x0),
+    W(CDP_S_LUT_LO_END_LOW_0, 0x100),
+    W(CDP_S_LUT_ACCESS_CFG_0, 0x0),
+    W(CDP_S_LUT_ACCESS_DATA_0, 0x0),
+    W(CDP_S_LUT_LE_START_HIGH_0, 0x0),
+    W(CDP_S_LUT_LO_END_HIGH_0, 0x0),
+    W(CDP_S_LUT_CFG_0, 0x1),
+    W(CDP_S_LUT_LE_SLOPE_SHIFT_0, 0x0),
+    W(CDP_S_LUT_LE_SLOPE_SCALE_0, 0x0),
+    W(CDP_S_LUT_INFO_0, 0x0),
+    W(CDP_S_LUT_LE_END_LOW_0, 0x40),
+    W(CDP_S_LUT_LO_SLOPE_SCALE_0, 0x0),
+    W(CDP_S_LUT_LE_END_HIGH_0, 0x0),
+    W(CDP_S_LUT_LO_START_HIGH_0, 0x0),
+    W(CDP_S_LUT_LO_START_LOW_0, 0x0),
+    W(CDP_S_LUT_LO_SLOPE_SHIFT_0, 0x0),
+};
+
+// CDP_0 from nvdla.c: an 8x8x32 INT8 cube, local response normalization
+// bypassed
+static const struct nvdla_write cdp_8x8[] = {
+    W(CDP_D_DATOUT_OFFSET_0, 0x80),
+    W(CDP_D_DST_SURFACE_STRIDE_0, 0x800),
+    W(CDP_RDMA_D_SRC_BASE_ADDR_LOW_0, 0x90000000),
+    W(CDP_D_DST_DMA_CFG_0, 0x1),
+    W(CDP_RDMA_D_DATA_CUBE_WIDTH_0, 0x7),
+    W(CDP_RDMA_D_DATA_FORMAT_0, 0x0),
+    W(CDP_D_DATIN_SCALE_0, 0x1),
+    W(CDP_D_DATOUT_SHIFTER_0, 0x0),
+    W(CDP_D_CYA_0, 0x0),
+    W(CDP_RDMA_D_PERF_ENABLE_0, 0x0),
+    W(CDP_D_LRN_CFG_0, 0x0),
+    W(CDP_RDMA_D_DATA_CUBE_CHANNEL_0, 0x1f),
+    W(CDP_D_DATA_FORMAT_0, 0x0),
+    W(CDP_D_DATIN_SHIFTER_0, 0x0),
+    W(CDP_D_PERF_ENABLE_0, 0x0),
+    W(CDP_RDMA_D_SRC_BASE_ADDR_HIGH_0, 0x0),
+    W(CDP_D_DST_BASE_ADDR_HIGH_0, 0x0),
+    W(CDP_RDMA_D_SRC_DMA_CFG_0, 0x1),
+    W(CDP_D_DATOUT_SCALE_0, 0x1),
+    W(CDP_D_DATIN_OFFSET_0, 0x80),
+    W(CDP_D_NAN_FLUSH_TO_ZERO_0, 0x0),
+    W(CDP_D_FUNC_BYPASS_0, 0x3),
+    W(CDP_D_DST_BASE_ADDR_LOW_0, 0x90080000),
+    W(CDP_RDMA_D_CYA_0, 0x0),
+    W(CDP_RDMA_D_SRC_SURFACE_STRIDE_0, 0x800),
+    W(CDP_D_DST_LINE_STRIDE_0, 0x100),
+    W(CDP_RDMA_D_SRC_LINE_STRIDE_0, 0x100),
+    W(CDP_RDMA_D_DATA_CUBE_HEIGHT_0, 0x7),
+};
+
+static const struct nvdla_write cdp_16x16[] = {
+    W(CDP_RDMA_D_DATA_CUBE_WIDTH_0, 0xf),
+    W(CDP_RDMA_D_DATA_CUBE_HEIGHT_0, 0xf),
+    W(CDP_RDMA_D_SRC_LINE_STRIDE_0, 0x200),
+    W(CDP_D_DST_LINE_STRIDE_0, 0x200),
+    W(CDP_RDMA_D_SRC_SURFACE_STRIDE_0, 0x2000),
+    W(CDP_D_DST_SURFACE_STRIDE_0, 0x2000),
+};
+
+static const struct nvdla_write cdp_32x32[] = {
+    W(CDP_RDMA_D_DATA_CUBE_WIDTH_0, 0x1f),
+    W(CDP_RDMA_D_DATA_CUBE_HEIGHT_0, 0x1f),
+    W(CDP_RDMA_D_SRC_LINE_STRIDE_0, 0x400),
+    W(CDP_D_DST_LINE_STRIDE_0, 0x400),
+    W(CDP_RDMA_D_SRC_SURFACE_STRIDE_0, 0x8000),
+    W(CDP_D_DST_SURFACE_STRIDE_0, 0x8000),
+};
+
+// 64 channels: two 32-channel surfaces
+static const struct nvdla_write cdp_8x8x64[] = {
+    W(CDP_RDMA_D_DATA_CUBE_CHANNEL_0, 0x3f),
+};
+
+static const struct nvdla_write cdp_enable[] = {
+    W(CDP_RDMA_D_OP_ENABLE_0, 0x1),
+    W(CDP_D_OP_ENABLE_0, 0x1),
+};
+
+// Played on top of cdp_8x8, so each only lists what differs
+static const struct nvdla_layer layers[] = {
+    LAYER("cdp_8x8", cdp_8x8, 2 * 0x800),
+    LAYER("cdp_16x16", cdp_16x16, 2 * 0x2000),
+    LAYER("cdp_32x32", cdp_32x32, 2 * 0x8000),
+    LAYER("cdp_8x8x64", cdp_8x8x64, 2 * 2 * 0x800),
+};
+
+static unsigned int play(const struct nvdla_write *writes, unsigned int n)
+{
+    unsigned int total = 0;
+
+    for (unsigned int i = 0; i < n; i++) {
+        for (uint32_t j = 0; j < writes[i].count; j++)
+            reg_write(writes[i].addr, writes[i].value + j);
+        total += writes[i].count;
+    }
+    return total;
+}
+
+static int run(const struct nvdla_layer *layer, int repeat)
+{
+    uint64_t start, config_cycles, run_cycles;
+    uint32_t group, done, status = 0;
+    int i;
+
+    start = rdcycle();
+    group = (reg_read(CDP_S_POINTER_0) >> CDP_S_POINTER_0_CONSUMER_SHIFT) & 1;
+    reg_write(CDP_S_POINTER_0, group);
+    reg_write(CDP_RDMA_S_POINTER_0, group);
+    play(cdp_8x8, sizeof(cdp_8x8) / sizeof(cdp_8x8[0]));
+    if (layer->writes != cdp_8x8)
+        play(layer->writes, layer->nwrites);
+    config_cycles = rdcycle() - start;
+
+    done = group ? GLB_S_INTR_STATUS_0_CDP_DONE_STATUS1_FIELD :
+                   GLB_S_INTR_STATUS_0_CDP_DONE_STATUS0_FIELD;
+    start = rdcycle();
+    play(cdp_enable, sizeof(cdp_enable) / sizeof(cdp_enable[0]));
+    for (i = 0; i < POLL_LIMIT; i++) {
+        status = reg_read(GLB_S_INTR_STATUS_0);
+        if (status & done)
+            break;
+    }
+    run_cycles = rdcycle() - start;
+
+    if (i == POLL_LIMIT) {
+        printf("Error: %s timed out, status %x\n", layer->name, status);
+        return 1;
+    }
+    // Write-one-to-clear, ready for the next layer
+    reg_write(GLB_S_INTR_STATUS_0, status);
+
+    printf("nvdla,%s,%d,%u,%lu,%lu,%lu\n", layer->name, repeat,
+           layer->bytes, config_cycles, run_cycles,
+           layer->bytes * 1000UL / run_cycles);
+    return 0;
+}
+
+int main(void)
+{
+    uint64_t start;
+    unsigned int nwrites;
+
+    start = rdcycle();
+    nwrites = play(cdp_lut, sizeof(cdp_lut) / sizeof(cdp_lut[0]));
+    printf("# nvdla-bench: %u LUT writes in %lu cycles\n",
+           nwrites, rdcycle() - start);
+    printf("# nvdla,layer,run,bytes,config_cycles,run_cycles,"
+           "bytes_per_kcycle\n");
+
+    for (unsigned int l = 0; l < sizeof(layers) / sizeof(layers[0]); l++) {
+        for (int r = 0; r < REPEATS; r++) {
+            if (run(&layers[l], r))
+                return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "rocc.h"
+#include "rocc-bench.h"
+
+/*
+ * Accumulator RoCC interface costs: command issue rate, round trip through
+ * rd, and loads through the accelerator's memory port for footprints from
+ * the L1 out to the L2. Set ACCUM_OPCODE to the custom opcode of the config
+ * (custom1 by default, as in WithAccumulatorRoCC).
+ */
+
+#ifndef ACCUM_OPCODE
+#define ACCUM_OPCODE 1
+#endif
+
+#define OPS 4096
+#define LINE_BYTES 64
+#define MIN_FOOTPRINT (1 << 10)
+#define MAX_FOOTPRINT (1 << 20)
+/* Each footprint is swept this many times, so every line is loaded */
+#define FOOTPRINT_PASSES 4
+
+static uint64_t buf[MAX_FOOTPRINT / sizeof(uint64_t)]
+	__attribute__ ((aligned (LINE_BYTES)));
+
+static inline void accum_write(int idx, unsigned long data)
+{
+	ROCC_INSTRUCTION_SS(ACCUM_OPCODE, data, idx, 0);
+}
+
+static inline unsigned long accum_read(int idx)
+{
+	unsigned long value;
+	ROCC_INSTRUCTION_DSS(ACCUM_OPCODE, value, 0, idx, 1);
+	return value;
+}
+
+/* No fence; rocc_bench_run() fences once before the timed loop */
+static inline void accum_load(int idx, void *ptr)
+{
+	ROCC_INSTRUCTION_SS(ACCUM_OPCODE, (uintptr_t) ptr, idx, 2);
+}
+
+static inline void accum_add(int idx, unsigned long addend)
+{
+	ROCC_INSTRUCTION_SS(ACCUM_OPCODE, addend, idx, 3);
+}
+
+static void add_throughput(unsigned long n, void *arg)
+{
+	(void) arg;
+	for (unsigned long i = 0; i < n; i++)
+		accum_add(i & 3, 1);
+}
+
+static void read_latency(unsigned long n, void *arg)
+{
+	unsigned long v = 0;
+
+	/* All accumulators hold 0, so v & 3 is 0 but still depends on v */
+	for (unsigned long i = 0; i < n; i++)
+		v = accum_read(v & 3);
+	*(volatile unsigned long *) arg = v;
+}
+
+static void load_footprint(unsigned long n, void *arg)
+{
+	unsigned long lines = *(unsigned long *) arg;
+
+	for (unsigned long i = 0, l = 0; i < n; i++) {
+		accum_load(0, (char *) buf + l * LINE_BYTES);
+		if (++l == lines)
+			l = 0;
+	}
+}
+
+int main(void)
+{
+	unsigned long sink, lines, ops, expected;
+
+	rocc_bench_header();
+
+	for (int i = 0; i < 4; i++)
+		accum_write(i, 0);
+	rocc_bench_run("accum", "add_throughput", 0, OPS, add_throughput, 0);
+
+	for (int i = 0; i < 4; i++)
+		accum_write(i, 0);
+	rocc_bench_run("accum", "read_latency", 0, OPS, read_latency, &sink);
+
+	for (size_t i = 0; i < sizeof(buf) / sizeof(buf[0]); i++)
+		buf[i] = i;
+	for (unsigned long bytes = MIN_FOOTPRINT; bytes <= MAX_FOOTPRINT;
+			bytes *= 2) {
+		lines = bytes / LINE_BYTES;
+		ops = lines * FOOTPRINT_PASSES;
+		if (ops < OPS)
+			ops = OPS;
+		rocc_bench_run("accum", "load_footprint", bytes, ops,
+				load_footprint, &lines);
+	}
+
+	/* The last load of the largest footprint has to have seen the right
+	 * line; lines and ops still hold its values */
+	expected = ((ops - 1) % lines) * (LINE_BYTES / sizeof(uint64_t));
+	if (accum_read(0) != expected) {
+		printf("Error: accumulator holds %lu, expected %lu\n",
+				accum_read(0), expected);
+		return 1;
+	}
+
+	return 0;
+}
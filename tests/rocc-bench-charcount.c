@@ -0,0 +1,103 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "rocc.h"
+#include "rocc-bench.h"
+
+/*
+ * Character counter against a plain C loop: round trip for a short string,
+ * then bytes scanned per cycle for strings from 64 B to 64 KiB. Set
+ * CHARCOUNT_OPCODE to the custom opcode of the config (custom2 by default).
+ */
+
+#ifndef CHARCOUNT_OPCODE
+#define CHARCOUNT_OPCODE 2
+#endif
+
+#define LATENCY_OPS 1024
+#define MIN_LEN 64
+#define MAX_LEN (64 << 10)
+
+static char text[MAX_LEN] __attribute__ ((aligned (64)));
+
+struct scan {
+	char *start;
+	unsigned long count;
+};
+
+static inline unsigned long count_chars(char *start, char needle)
+{
+	unsigned long count;
+	ROCC_INSTRUCTION_DSS(CHARCOUNT_OPCODE, count, start, needle, 0);
+	return count;
+}
+
+static unsigned long count_chars_sw(const char *start, char needle)
+{
+	unsigned long count = 0;
+
+	for (; *start; start++)
+		count += *start == needle;
+	return count;
+}
+
+static void latency(unsigned long n, void *arg)
+{
+	struct scan *s = arg;
+	unsigned long count = 0;
+
+	/* count is always even, so the offset is 0 but depends on it */
+	for (unsigned long i = 0; i < n; i++)
+		count = count_chars(s->start + (count & 1), 'o');
+	s->count = count;
+}
+
+/* One scan per run; ops counts bytes, so the rate is cycles per byte */
+static void scan_rocc(unsigned long n, void *arg)
+{
+	struct scan *s = arg;
+
+	(void) n;
+	s->count = count_chars(s->start, 'o');
+}
+
+static void scan_sw(unsigned long n, void *arg)
+{
+	struct scan *s = arg;
+
+	(void) n;
+	s->count = count_chars_sw(s->start, 'o');
+}
+
+int main(void)
+{
+	static char quick[64] __attribute__ ((aligned (64))) =
+		"The quick brown fox jumped over the lazy dog";
+	struct scan s = {quick, 0};
+	unsigned long hw, sw;
+
+	rocc_bench_header();
+	rocc_bench_run("charcount", "latency", 44, LATENCY_OPS, latency, &s);
+
+	for (int i = 0; i < MAX_LEN; i++)
+		text[i] = quick[i % 44];
+
+	for (unsigned long len = MIN_LEN; len <= MAX_LEN; len *= 2) {
+		text[len - 1] = '\0';
+		s.start = text;
+
+		rocc_bench_run("charcount", "scan", len, len, scan_rocc, &s);
+		hw = s.count;
+		rocc_bench_run("charcount", "scan_sw", len, len, scan_sw, &s);
+		sw = s.count;
+
+		text[len - 1] = quick[(len - 1) % 44];
+		if (hw != sw) {
+			printf("Error: counted %lu in %lu bytes, expected %lu\n",
+					hw, len, sw);
+			return 1;
+		}
+	}
+
+	return 0;
+}
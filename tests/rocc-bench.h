@@ -0,0 +1,65 @@
+#ifndef ROCC_BENCH_H
+#define ROCC_BENCH_H
+
+#include <stdio.h>
+
+#include <riscv-pk/encoding.h>
+
+/*
+ * Timing for RoCC microbenchmarks.
+ *
+ * A benchmark is a function that runs n operations in a loop. It is run once
+ * with a few operations to warm up the caches and the accelerator, then
+ * timed with rdcycle and rdinstret around the whole loop, so the call and
+ * loop overhead is amortized rather than in every sample. Typical loops:
+ *
+ *   throughput  back-to-back commands without a destination register
+ *   latency     a chain of commands, each using the last one's result
+ *   footprint   commands that touch memory, over buffers of a given size
+ *
+ * Every result is one CSV row, with the columns named by rocc_bench_header():
+ *
+ *   rocc,<accel>,<test>,<param>,<ops>,<cycles>,<instret>,<cycles_per_op_x100>
+ *
+ * <param> is test specific, e.g. the footprint in bytes, or 0. Software
+ * baselines go in the same table under their own test name.
+ */
+
+#define ROCC_BENCH_WARMUP_OPS 16
+
+typedef void (*rocc_bench_fn)(unsigned long n, void *arg);
+
+static inline void rocc_bench_header(void)
+{
+	printf("# rocc,accel,test,param,ops,cycles,instret,"
+			"cycles_per_op_x100\n");
+}
+
+/* Returns the cycles per operation in hundredths */
+static inline unsigned long rocc_bench_run(
+		const char *accel,
+		const char *test,
+		unsigned long param,
+		unsigned long ops,
+		rocc_bench_fn fn,
+		void *arg)
+{
+	unsigned long cycles, instret, per_op;
+
+	fn(ops < ROCC_BENCH_WARMUP_OPS ? ops : ROCC_BENCH_WARMUP_OPS, arg);
+
+	/* Commands that touch memory are ordered with the core's accesses */
+	asm volatile ("fence" ::: "memory");
+	instret = rdinstret();
+	cycles = rdcycle();
+	fn(ops, arg);
+	cycles = rdcycle() - cycles;
+	instret = rdinstret() - instret;
+
+	per_op = ops ? cycles * 100 / ops : 0;
+	printf("rocc,%s,%s,%lu,%lu,%lu,%lu,%lu\n", accel, test, param, ops,
+			cycles, instret, per_op);
+	return per_op;
+}
+
+#endif
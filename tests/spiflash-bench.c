@@ -0,0 +1,143 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <riscv-pk/encoding.h>
+#include "mmio.h"
+#include "spiflash.h"
+
+/*
+ * Memory-mapped read bandwidth of the SPI flash for each read command the
+ * model supports, over buffer sizes and three access patterns:
+ *
+ *   seq     every word in order
+ *   stride  one word per STRIDE bytes
+ *   random  every word, in a scrambled order
+ *
+ * Each (mode, pattern) pair reads from its own WINDOW of the image, so
+ * nothing is served from a cache filled by an earlier run. The data is
+ * checked against the spiflash.py image (0xdeadbeef - address). Results
+ * are CSV rows:
+ *
+ *   spiflash,<mode>,<pattern>,<span>,<bytes_read>,<cycles>,<bytes_per_kcycle>
+ *
+ * The model only implements single and quad data; build with
+ * -DSPIFLASH_BENCH_DUAL for parts that take the dual read commands.
+ */
+
+#define WINDOW 0x8000
+#define STRIDE 64
+#define NPATTERNS 3
+
+struct mode {
+	const char *name;
+	uint8_t cmd;
+	uint8_t addr_len;
+	uint8_t pad_cnt;
+	uint8_t addr_proto;
+	uint8_t data_proto;
+};
+
+static const struct mode modes[] = {
+	{"read3", 0x03, 3, 0, SPIFLASH_PROTO_SINGLE, SPIFLASH_PROTO_SINGLE},
+	{"read4", 0x13, 4, 0, SPIFLASH_PROTO_SINGLE, SPIFLASH_PROTO_SINGLE},
+	{"fast3", 0x0B, 3, 8, SPIFLASH_PROTO_SINGLE, SPIFLASH_PROTO_SINGLE},
+	{"fast4", 0x0C, 4, 8, SPIFLASH_PROTO_SINGLE, SPIFLASH_PROTO_SINGLE},
+#ifdef SPIFLASH_BENCH_DUAL
+	{"dual_o3", 0x3B, 3, 8, SPIFLASH_PROTO_SINGLE, SPIFLASH_PROTO_DUAL},
+	{"dual_io3", 0xBB, 3, 4, SPIFLASH_PROTO_DUAL, SPIFLASH_PROTO_DUAL},
+#endif
+	{"quad_o3", 0x6B, 3, 8, SPIFLASH_PROTO_SINGLE, SPIFLASH_PROTO_QUAD},
+	{"quad_o4", 0x6C, 4, 8, SPIFLASH_PROTO_SINGLE, SPIFLASH_PROTO_QUAD},
+	{"quad_io3", 0xEB, 3, 8, SPIFLASH_PROTO_QUAD, SPIFLASH_PROTO_QUAD},
+	{"quad_io4", 0xEC, 4, 8, SPIFLASH_PROTO_QUAD, SPIFLASH_PROTO_QUAD},
+};
+
+static const uint32_t spans[] = {0x100, 0x400, 0x1000, 0x4000};
+
+static const char *pattern_names[NPATTERNS] = {"seq", "stride", "random"};
+
+static void set_mode(const struct mode *mode)
+{
+	spiflash_ffmt ffmt;
+
+	ffmt.bits = 0;
+	ffmt.fields.cmd_en = 1;
+	ffmt.fields.addr_len = mode->addr_len;
+	ffmt.fields.pad_cnt = mode->pad_cnt;
+	ffmt.fields.cmd_proto = SPIFLASH_PROTO_SINGLE;
+	ffmt.fields.addr_proto = mode->addr_proto;
+	ffmt.fields.data_proto = mode->data_proto;
+	ffmt.fields.cmd_code = mode->cmd;
+	ffmt.fields.pad_code = 0x00;
+	configure_spiflash(ffmt);
+}
+
+/* Word offset of the i-th load of n; n is a power of two */
+static inline uint32_t word_at(int pattern, uint32_t i, uint32_t n)
+{
+	switch (pattern) {
+	case 1:
+		return i * (STRIDE / 4);
+	case 2:
+		/* An odd multiplier permutes 0..n-1 */
+		return (i * 0x9E3779B1u) & (n - 1);
+	default:
+		return i;
+	}
+}
+
+/* Returns 1 if the data read back was wrong */
+static int run(const struct mode *mode, int pattern, uint32_t base,
+		uint32_t span)
+{
+	uint32_t words = span / 4;
+	uint32_t loads = pattern == 1 ? span / STRIDE : words;
+	uint32_t got = 0, expected = 0, addr;
+	unsigned long start, cycles;
+
+	start = rdcycle();
+	for (uint32_t i = 0; i < loads; i++)
+		got ^= reg_read32(SPIFLASH_BASE_MEM + base +
+				word_at(pattern, i, words) * 4);
+	cycles = rdcycle() - start;
+
+	for (uint32_t i = 0; i < loads; i++) {
+		addr = base + word_at(pattern, i, words) * 4;
+		expected ^= 0xdeadbeef - addr;
+	}
+
+	printf("spiflash,%s,%s,%u,%u,%lu,%lu\n", mode->name,
+			pattern_names[pattern], span, loads * 4, cycles,
+			loads * 4000UL / cycles);
+	if (got != expected) {
+		printf("Error: %s %s at 0x%x read back wrong data\n",
+				mode->name, pattern_names[pattern], base);
+		return 1;
+	}
+	return 0;
+}
+
+int main(void)
+{
+	uint32_t base = 0;
+
+	printf("# spiflash,mode,pattern,span,bytes_read,cycles,"
+			"bytes_per_kcycle\n");
+
+	for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+		set_mode(&modes[m]);
+		for (int p = 0; p < NPATTERNS; p++) {
+			uint32_t offset = base;
+
+			for (size_t s = 0; s < sizeof(spans) / sizeof(spans[0]);
+					s++) {
+				if (run(&modes[m], p, offset, spans[s]))
+					return 1;
+				offset += spans[s];
+			}
+			base += WINDOW;
+		}
+	}
+
+	return 0;
+}
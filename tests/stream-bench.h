@@ -0,0 +1,91 @@
+#ifndef STREAM_BENCH_H
+#define STREAM_BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <riscv-pk/encoding.h>
+#include "mmio.h"
+
+/*
+ * Throughput of the MMIO-fed streaming blocks (TLWriteQueue -> block ->
+ * TLReadQueue in DspBlocks.scala).
+ *
+ * These blocks have no DMA front end, so samples still go through the queue
+ * registers one at a time. What stream_pump() avoids is the round trip per
+ * sample: it keeps the write queue topped up and drains the read queue by
+ * its count, so the block sees back-to-back input whenever the core can
+ * supply it. stream_mmio_cost() times a single register read so the two can
+ * be told apart. Results are CSV rows:
+ *
+ *   stream,<block>,<samples>,<cycles>,<cycles_per_sample_x100>
+ *   mmio,<block>,<reads>,<cycles>,<cycles_per_read_x100>
+ */
+
+struct stream_port {
+	uintptr_t write;
+	uintptr_t write_count;
+	uintptr_t read;
+	uintptr_t read_count;
+	/* Depth of the write queue, the depth parameter of the block */
+	unsigned int depth;
+};
+
+static inline void stream_header(void)
+{
+	printf("# stream,block,samples,cycles,cycles_per_sample_x100\n");
+	printf("# mmio,block,reads,cycles,cycles_per_read_x100\n");
+}
+
+/*
+ * Pushes n_in samples and pulls n_out results, never writing to a full
+ * queue (the write would stall the bus while the block waits for its output
+ * queue to drain). Returns the cycles taken.
+ */
+static inline unsigned long stream_pump(
+		const struct stream_port *port,
+		const uint64_t *in,
+		unsigned long n_in,
+		uint32_t *out,
+		unsigned long n_out)
+{
+	unsigned long sent = 0, got = 0, start = rdcycle();
+	unsigned int space, avail;
+
+	while (got < n_out) {
+		if (sent < n_in) {
+			space = port->depth - reg_read32(port->write_count);
+			for (; space > 0 && sent < n_in; space--)
+				reg_write64(port->write, in[sent++]);
+		}
+
+		avail = reg_read32(port->read_count);
+		for (; avail > 0 && got < n_out; avail--)
+			out[got++] = reg_read32(port->read);
+	}
+
+	return rdcycle() - start;
+}
+
+static inline void stream_report(
+		const char *block,
+		unsigned long samples,
+		unsigned long cycles)
+{
+	printf("stream,%s,%lu,%lu,%lu\n", block, samples, cycles,
+			samples ? cycles * 100 / samples : 0);
+}
+
+static inline void stream_mmio_cost(const char *block, uintptr_t addr)
+{
+	const unsigned long reads = 256;
+	unsigned long start = rdcycle();
+
+	for (unsigned long i = 0; i < reads; i++)
+		reg_read32(addr);
+	start = rdcycle() - start;
+	printf("mmio,%s,%lu,%lu,%lu\n", block, reads, start,
+			start * 100 / reads);
+}
+
+#endif
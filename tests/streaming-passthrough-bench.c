@@ -0,0 +1,49 @@
+#define PASSTHROUGH_WRITE 0x2200
+#define PASSTHROUGH_WRITE_COUNT 0x2208
+#define PASSTHROUGH_READ 0x2300
+#define PASSTHROUGH_READ_COUNT 0x2308
+#define PASSTHROUGH_DEPTH 8
+
+#include "mmio.h"
+#include "stream-bench.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*
+ * Streams SAMPLES words through the passthrough block and checks they come
+ * back unchanged. Use with a config that has WithStreamingPassthrough.
+ */
+
+#define SAMPLES 4096
+
+static uint64_t in[SAMPLES];
+static uint32_t out[SAMPLES];
+
+int main(void)
+{
+  const struct stream_port port = {
+    PASSTHROUGH_WRITE, PASSTHROUGH_WRITE_COUNT,
+    PASSTHROUGH_READ, PASSTHROUGH_READ_COUNT,
+    PASSTHROUGH_DEPTH,
+  };
+  unsigned long cycles;
+
+  for (int i = 0; i < SAMPLES; i++)
+    in[i] = (uint32_t) (i * 2654435761u);
+
+  stream_header();
+  stream_mmio_cost("passthrough", PASSTHROUGH_READ_COUNT);
+  cycles = stream_pump(&port, in, SAMPLES, out, SAMPLES);
+  stream_report("passthrough", SAMPLES, cycles);
+
+  for (int i = 0; i < SAMPLES; i++) {
+    if (out[i] != (uint32_t) in[i]) {
+      printf("Fail: sample %d: got %u expected %u\n",
+             i, out[i], (uint32_t) in[i]);
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <riscv-pk/encoding.h>
+#include "sync.h"
+
+/*
+ * Lock acquire latency and barrier cost against the number of harts.
+ *
+ * For n = 1 to the number of harts that booted, harts 0 to n - 1 run ITERS
+ * lock/unlock pairs around a shared increment, or ITERS barriers, while the
+ * rest wait. Output is CSV in the style of mem-bench:
+ *
+ *   lock,<ticket|mcs>,<harts>,<cycles per acquire and release>
+ *   barrier,<central|tree|dissem>,<harts>,<cycles per barrier>
+ */
+
+#ifndef ITERS
+#define ITERS 1000
+#endif
+
+static struct sync_central_barrier outer;
+static struct sync_ticket_lock ticket;
+static struct sync_mcs_lock mcs;
+static struct sync_central_barrier central;
+static struct sync_tree_barrier tree;
+static struct sync_dissem_barrier dissem;
+static struct sync_counter cycles;
+static volatile long shared;
+
+static void ticket_op(int id)
+{
+	(void) id;
+	sync_ticket_lock(&ticket);
+	shared++;
+	sync_ticket_unlock(&ticket);
+}
+
+static void mcs_op(int id)
+{
+	sync_mcs_lock(&mcs, id);
+	shared++;
+	sync_mcs_unlock(&mcs, id);
+}
+
+static void central_op(int id)
+{
+	sync_central_wait(&central, id);
+}
+
+static void tree_op(int id)
+{
+	sync_tree_wait(&tree, id);
+}
+
+static void dissem_op(int id)
+{
+	sync_dissem_wait(&dissem, id);
+}
+
+static const struct {
+	const char *kind;
+	const char *name;
+	void (*op)(int id);
+} tests[] = {
+	{"lock", "ticket", ticket_op},
+	{"lock", "mcs", mcs_op},
+	{"barrier", "central", central_op},
+	{"barrier", "tree", tree_op},
+	{"barrier", "dissem", dissem_op},
+};
+
+static int run(int id)
+{
+	for (int n = 1; n <= sync_nharts; n++) {
+		for (size_t t = 0; t < sizeof(tests) / sizeof(tests[0]); t++) {
+			if (id == 0) {
+				shared = 0;
+				sync_central_init(&central, n);
+				sync_tree_init(&tree, n);
+				sync_dissem_init(&dissem, n);
+			}
+			sync_central_wait(&outer, id);
+
+			if (id < n) {
+				unsigned long start = rdcycle();
+
+				for (int i = 0; i < ITERS; i++)
+					tests[t].op(id);
+				cycles.slot[id].v = rdcycle() - start;
+			}
+			sync_central_wait(&outer, id);
+
+			if (id != 0)
+				continue;
+			if (tests[t].op == ticket_op || tests[t].op == mcs_op) {
+				if (shared != (long) n * ITERS) {
+					printf("Error: %s lost updates: %ld != %d\n",
+							tests[t].name, shared, n * ITERS);
+					return 1;
+				}
+			}
+			/* Mean over the harts; they all finish together anyway */
+			printf("%s,%s,%d,%ld\n", tests[t].kind, tests[t].name, n,
+					sync_counter_sum(&cycles, n) / n / ITERS);
+		}
+	}
+	return 0;
+}
+
+void __main(void)
+{
+	int id = sync_join();
+
+	sync_wait(id);
+	run(id);
+	while (1);
+}
+
+int main(void)
+{
+	int nharts = sync_discover(SYNC_CHECKIN_CYCLES);
+
+	sync_central_init(&outer, nharts);
+	printf("# sync-bench: %d harts, %d iterations\n", nharts, ITERS);
+	printf("# lock,kind,harts,cycles_per_acquire\n");
+	printf("# barrier,kind,harts,cycles_per_barrier\n");
+	sync_release();
+
+	return run(0);
+}
@@ -0,0 +1,322 @@
+#ifndef SYNC_H
+#define SYNC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <riscv-pk/encoding.h>
+
+/*
+ * Synchronization for multi-hart baremetal tests.
+ *
+ * Hart 0 runs main() and every other hart comes up through __main(). There
+ * is no device tree parser here, so the hart count is whatever checks in:
+ *
+ *   void __main(void)            int main(void)
+ *   {                            {
+ *     int id = sync_join();        sync_discover(SYNC_CHECKIN_CYCLES);
+ *     sync_wait(id);               ... set up shared state ...
+ *     work(id);                    sync_release();
+ *   }                              work(0);
+ *                                }
+ *
+ * Ids are dense, 0 to sync_nharts - 1, whatever the mhartids are. Harts that
+ * check in late never leave sync_wait().
+ *
+ * Everything a hart spins on sits in its own cache line, so spinning stays in
+ * the hart's cache until the line is written.
+ */
+
+#define SYNC_MAX_HARTS 64
+#define SYNC_LINE_BYTES 64
+#define SYNC_CHECKIN_CYCLES 100000
+/* ceil(log2(SYNC_MAX_HARTS)) */
+#define SYNC_DISSEM_ROUNDS 6
+#define SYNC_TREE_RADIX 4
+
+struct sync_slot {
+	volatile long v;
+} __attribute__ ((aligned (SYNC_LINE_BYTES)));
+
+static struct sync_slot sync_checked_in;
+static struct sync_slot sync_started;
+static int sync_nharts = 1;
+
+/*
+ * Hart discovery
+ */
+
+static inline int sync_join(void)
+{
+	if (read_csr(mhartid) == 0)
+		return 0;
+	return __sync_fetch_and_add(&sync_checked_in.v, 1) + 1;
+}
+
+/* Hart 0: wait for the others to check in and count them */
+static inline int sync_discover(unsigned long cycles)
+{
+	unsigned long start = rdcycle();
+
+	while (rdcycle() - start < cycles);
+	sync_nharts = sync_checked_in.v + 1;
+	if (sync_nharts > SYNC_MAX_HARTS)
+		sync_nharts = SYNC_MAX_HARTS;
+	return sync_nharts;
+}
+
+/* Hart 0: let the others out of sync_wait() */
+static inline void sync_release(void)
+{
+	__sync_synchronize();
+	sync_started.v = 1;
+}
+
+static inline void sync_wait(int id)
+{
+	while (!sync_started.v);
+	__sync_synchronize();
+	if (id >= sync_nharts)
+		while (1);
+}
+
+/*
+ * Per-hart counters, summed on demand
+ */
+
+struct sync_counter {
+	struct sync_slot slot[SYNC_MAX_HARTS];
+};
+
+static inline void sync_counter_add(struct sync_counter *c, int id, long n)
+{
+	c->slot[id].v += n;
+}
+
+static inline long sync_counter_sum(struct sync_counter *c, int nharts)
+{
+	long sum = 0;
+
+	for (int i = 0; i < nharts; i++)
+		sum += c->slot[i].v;
+	return sum;
+}
+
+/*
+ * Locks
+ */
+
+struct sync_ticket_lock {
+	struct sync_slot next;
+	struct sync_slot serving;
+};
+
+static inline void sync_ticket_lock(struct sync_ticket_lock *l)
+{
+	long ticket = __sync_fetch_and_add(&l->next.v, 1);
+
+	while (l->serving.v != ticket);
+	__sync_synchronize();
+}
+
+static inline void sync_ticket_unlock(struct sync_ticket_lock *l)
+{
+	__sync_synchronize();
+	l->serving.v = l->serving.v + 1;
+}
+
+/* Each waiter spins on its own node, so a release touches one other hart */
+struct sync_mcs_node {
+	struct sync_mcs_node *volatile next;
+	volatile int locked;
+} __attribute__ ((aligned (SYNC_LINE_BYTES)));
+
+struct sync_mcs_lock {
+	struct sync_mcs_node *volatile tail
+		__attribute__ ((aligned (SYNC_LINE_BYTES)));
+	struct sync_mcs_node node[SYNC_MAX_HARTS];
+};
+
+static inline void sync_mcs_lock(struct sync_mcs_lock *l, int id)
+{
+	struct sync_mcs_node *me = &l->node[id], *pred;
+
+	me->next = NULL;
+	me->locked = 1;
+	pred = __atomic_exchange_n(&l->tail, me, __ATOMIC_ACQ_REL);
+	if (pred) {
+		pred->next = me;
+		while (me->locked);
+	}
+	__sync_synchronize();
+}
+
+static inline void sync_mcs_unlock(struct sync_mcs_lock *l, int id)
+{
+	struct sync_mcs_node *me = &l->node[id], *expected = me;
+
+	if (!me->next) {
+		if (__atomic_compare_exchange_n(&l->tail, &expected, NULL, 0,
+				__ATOMIC_RELEASE, __ATOMIC_RELAXED))
+			return;
+		/* A successor is between the exchange and linking in */
+		while (!me->next);
+	}
+	__sync_synchronize();
+	me->next->locked = 0;
+}
+
+/*
+ * Barriers. The *_init functions must run before any hart waits, and the
+ * barrier is for harts 0 to n - 1.
+ */
+
+/* One shared counter, as in mt-hello; the baseline for the others */
+struct sync_central_barrier {
+	struct sync_slot count;
+	struct sync_slot sense;
+	struct sync_slot local[SYNC_MAX_HARTS];
+	int n;
+};
+
+static inline void sync_central_init(struct sync_central_barrier *b, int n)
+{
+	b->count.v = 0;
+	b->sense.v = 0;
+	for (int i = 0; i < SYNC_MAX_HARTS; i++)
+		b->local[i].v = 0;
+	b->n = n;
+	__sync_synchronize();
+}
+
+static inline void sync_central_wait(struct sync_central_barrier *b, int id)
+{
+	long sense = !b->local[id].v;
+
+	b->local[id].v = sense;
+	__sync_synchronize();
+	if (__sync_fetch_and_add(&b->count.v, 1) == b->n - 1) {
+		b->count.v = 0;
+		__sync_synchronize();
+		b->sense.v = sense;
+	} else {
+		while (b->sense.v != sense);
+	}
+	__sync_synchronize();
+}
+
+/*
+ * Combining tree: harts arrive in groups of SYNC_TREE_RADIX and the last of
+ * each group carries on up, so no counter sees more than RADIX updates. The
+ * last arrival at the root releases everyone.
+ */
+struct sync_tree_node {
+	volatile long count;
+	int k;
+	int parent;
+} __attribute__ ((aligned (SYNC_LINE_BYTES)));
+
+struct sync_tree_barrier {
+	struct sync_tree_node node[SYNC_MAX_HARTS];
+	struct sync_slot sense;
+	struct sync_slot local[SYNC_MAX_HARTS];
+};
+
+static inline void sync_tree_init(struct sync_tree_barrier *b, int n)
+{
+	int level = 0, width = n, next;
+
+	/* Levels are laid out leaves first; hart i arrives at node i / RADIX */
+	do {
+		next = (width + SYNC_TREE_RADIX - 1) / SYNC_TREE_RADIX;
+		for (int i = 0; i < next; i++) {
+			struct sync_tree_node *node = &b->node[level + i];
+			int k = width - i * SYNC_TREE_RADIX;
+
+			node->count = 0;
+			node->k = k < SYNC_TREE_RADIX ? k : SYNC_TREE_RADIX;
+			node->parent = next > 1 ?
+				level + next + i / SYNC_TREE_RADIX : -1;
+		}
+		level += next;
+		width = next;
+	} while (width > 1);
+
+	b->sense.v = 0;
+	for (int i = 0; i < SYNC_MAX_HARTS; i++)
+		b->local[i].v = 0;
+	__sync_synchronize();
+}
+
+static inline void sync_tree_wait(struct sync_tree_barrier *b, int id)
+{
+	struct sync_tree_node *node = &b->node[id / SYNC_TREE_RADIX];
+	long sense = !b->local[id].v;
+
+	b->local[id].v = sense;
+	__sync_synchronize();
+	for (;;) {
+		if (__sync_fetch_and_add(&node->count, 1) != node->k - 1) {
+			while (b->sense.v != sense);
+			break;
+		}
+		/* Nobody comes back to this node until the release */
+		node->count = 0;
+		if (node->parent < 0) {
+			__sync_synchronize();
+			b->sense.v = sense;
+			break;
+		}
+		node = &b->node[node->parent];
+	}
+	__sync_synchronize();
+}
+
+/*
+ * Dissemination: in round r each hart signals hart id + 2^r and waits for
+ * hart id - 2^r. No atomics and no shared counter, at the cost of
+ * log2(n) rounds of flags.
+ */
+struct sync_dissem_barrier {
+	struct sync_slot flag[SYNC_MAX_HARTS][2][SYNC_DISSEM_ROUNDS];
+	/* Per hart: sense in bit 1, parity in bit 0 */
+	struct sync_slot local[SYNC_MAX_HARTS];
+	int n;
+	int rounds;
+};
+
+static inline void sync_dissem_init(struct sync_dissem_barrier *b, int n)
+{
+	for (int i = 0; i < SYNC_MAX_HARTS; i++) {
+		for (int r = 0; r < SYNC_DISSEM_ROUNDS; r++) {
+			b->flag[i][0][r].v = 0;
+			b->flag[i][1][r].v = 0;
+		}
+		b->local[i].v = 2;
+	}
+	b->n = n;
+	b->rounds = 0;
+	while ((1 << b->rounds) < n)
+		b->rounds++;
+	__sync_synchronize();
+}
+
+static inline void sync_dissem_wait(struct sync_dissem_barrier *b, int id)
+{
+	long sense = b->local[id].v >> 1;
+	int parity = b->local[id].v & 1;
+
+	__sync_synchronize();
+	for (int r = 0; r < b->rounds; r++) {
+		int partner = (id + (1 << r)) % b->n;
+
+		b->flag[partner][parity][r].v = sense;
+		while (b->flag[id][parity][r].v != sense);
+	}
+	if (parity)
+		sense = !sense;
+	b->local[id].v = (sense << 1) | !parity;
+	__sync_synchronize();
+}
+
+#endif